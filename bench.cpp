@@ -0,0 +1,215 @@
+#include "bench.h"
+#include "c8vm.h"
+#include "c8motor.h"
+#include "c8grupo.h"
+#include "c8rom.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Quadros de 60Hz entre duas mudanças da entrada roteirizada
+#define BENCH_QUADROS_POR_TECLA 10
+
+// Entrada roteirizada: a cada BENCH_QUADROS_POR_TECLA quadros solta todas as
+// teclas e, metade das vezes, aperta uma tecla sorteada (xorshift32 com
+// semente fixa, então toda execução vê a mesma sequência). Retorna a tecla
+// a apertar, -1 para só soltar todas ou -2 se o quadro não muda a entrada.
+static int bench_sortear_tecla(uint64_t quadro, uint32_t* semente) {
+    if (quadro % BENCH_QUADROS_POR_TECLA != 0) return -2;
+
+    uint32_t x = *semente;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    *semente = x;
+
+    return (x & 0x100) ? (int)(x % CHIP8_KEYS) : -1;
+}
+
+static void bench_entrada(VM& vm, uint64_t quadro, uint32_t* semente) {
+    int tecla = bench_sortear_tecla(quadro, semente);
+    if (tecla == -2) return;
+
+    for (int k = 0; k < CHIP8_KEYS; k++) vm.VM_ProcessarInput(k, false);
+    if (tecla >= 0) vm.VM_ProcessarInput(tecla, true);
+}
+
+// Roda até 'ciclos' instruções em quadros de hz/60 ciclos (a fração é
+// distribuída entre os quadros, sem deriva). Com 'grupos' != NULL executa
+// uma instrução por vez e conta quantas de cada grupo (1º nibble) rodaram.
+// Retorna quantos ciclos foram executados até o fim ou até a falha.
+static uint64_t bench_rodar(VM& vm, Motor* motor, uint64_t ciclos, int hz,
+                            uint64_t* grupos, VM_Status* status) {
+    uint32_t semente = 0xC8C8C8C8;
+    uint64_t feitos = 0;
+    *status = VM_OK;
+
+    for (uint64_t quadro = 0; feitos < ciclos; quadro++) {
+        bench_entrada(vm, quadro, &semente);
+
+        uint64_t n = (quadro + 1) * hz / 60 - quadro * hz / 60;
+        if (n > ciclos - feitos) n = ciclos - feitos;
+
+        if (grupos == NULL) {
+            *status = motor->Executar(vm, n);
+            if (*status != VM_OK) return feitos;
+            feitos += n;
+        } else {
+            for (uint64_t i = 0; i < n; i++) {
+                grupos[vm.RAM[vm.PC & (vm.tam_ram - 1)] >> 4]++;
+                *status = vm.VM_ExecutarInstrucao();
+                if (*status != VM_OK) return feitos;
+                feitos++;
+            }
+        }
+
+        vm.VM_ProcessarTimers();
+    }
+    return feitos;
+}
+
+// Nome da ROM sem o diretório
+static const char* bench_nome(const std::string& caminho) {
+    const char* barra = strrchr(caminho.c_str(), '/');
+    return barra ? barra + 1 : caminho.c_str();
+}
+
+int Bench_Executar(const std::vector<std::string>& roms, uint64_t ciclos,
+                   const char* nome_motor, int hz, VM_Quirks quirks) {
+    Motor* motor = Motor_Criar(nome_motor);
+    if (motor == NULL) {
+        fprintf(stderr, "Erro: Motor desconhecido '%s' (use: %s)\n", nome_motor, MOTORES_DISPONIVEIS);
+        return 1;
+    }
+
+    VM vm;
+    uint64_t total_ciclos = 0, total_espera = 0;
+    double total_segundos = 0;
+    int falhas = 0;
+
+    for (size_t r = 0; r < roms.size(); r++) {
+        std::string erro;
+        const ImagemROM* img = ROM_Carregar(roms[r].c_str(), 0x200, &erro);
+        if (img == NULL) {
+            fprintf(stderr, "Erro: ROM '%s': %s\n", roms[r].c_str(), erro.c_str());
+            falhas++;
+            continue;
+        }
+
+        // Passo 1 (cronometrado): o motor escolhido, sem nenhuma medição por instrução
+        vm.VM_Inicializar(img->pc_inicial, img->RAM.data(), img->tam_ram);
+        if (!vm.VM_DefinirQuirks(quirks, &erro)) {
+            fprintf(stderr, "Erro: ROM '%s': %s\n", roms[r].c_str(), erro.c_str());
+            falhas++;
+            continue;
+        }
+        motor->InvalidarTudo();
+        motor->ciclos_em_espera = 0;
+
+        VM_Status status;
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        uint64_t feitos = bench_rodar(vm, motor, ciclos, hz, NULL, &status);
+        double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        // A vazão conta só as instruções executadas de fato: os ciclos que o
+        // motor pulou em esperas ocupadas saem à parte
+        uint64_t espera = motor->ciclos_em_espera;
+        uint64_t executadas = feitos - espera;
+
+        // Passo 2 (não cronometrado): mesma execução, contando os grupos de opcode
+        uint64_t grupos[16] = {0};
+        VM_Status status_contagem;
+        vm.VM_Inicializar(img->pc_inicial, img->RAM.data(), img->tam_ram);
+        vm.VM_DefinirQuirks(quirks, NULL); // Já conferido no passo 1
+        bench_rodar(vm, motor, feitos, hz, grupos, &status_contagem);
+
+        printf("{\"rom\":\"%s\",\"motor\":\"%s\",\"ciclos\":%llu,\"ciclos_em_espera\":%llu,\"segundos\":%.6f,"
+               "\"instrucoes_por_segundo\":%.0f,\"ns_por_instrucao\":%.3f,\"status\":\"%s\",\"grupos\":{",
+               bench_nome(roms[r]), nome_motor, (unsigned long long)feitos, (unsigned long long)espera, segundos,
+               segundos > 0 ? executadas / segundos : 0.0, executadas ? segundos * 1e9 / executadas : 0.0,
+               VM_DescreverStatus(status));
+        for (int g = 0; g < 16; g++) {
+            printf("%s\"%X\":%llu", g ? "," : "", g, (unsigned long long)grupos[g]);
+        }
+        printf("}}\n");
+        fflush(stdout);
+
+        total_ciclos += feitos;
+        total_espera += espera;
+        total_segundos += segundos;
+        if (status != VM_OK) falhas++;
+    }
+
+    uint64_t total_executadas = total_ciclos - total_espera;
+    printf("{\"rom\":\"(total)\",\"motor\":\"%s\",\"ciclos\":%llu,\"ciclos_em_espera\":%llu,\"segundos\":%.6f,"
+           "\"instrucoes_por_segundo\":%.0f,\"ns_por_instrucao\":%.3f,\"falhas\":%d}\n",
+           nome_motor, (unsigned long long)total_ciclos, (unsigned long long)total_espera, total_segundos,
+           total_segundos > 0 ? total_executadas / total_segundos : 0.0,
+           total_executadas ? total_segundos * 1e9 / total_executadas : 0.0, falhas);
+
+    delete motor;
+    return 0;
+}
+
+int Bench_ExecutarGrupo(const std::vector<std::string>& roms, uint64_t ciclos,
+                        int instancias, int hz, VM_Quirks quirks) {
+    GrupoVM* grupo = new GrupoVM(instancias);
+    uint64_t total_ciclos = 0;
+    double total_segundos = 0;
+    std::vector<uint32_t> sementes(instancias);
+
+    for (size_t r = 0; r < roms.size(); r++) {
+        std::string erro;
+        grupo->Inicializar(0x200);
+        if (!grupo->DefinirQuirks(quirks, &erro) || !grupo->CarregarROM(roms[r].c_str(), 0x200, &erro)) {
+            fprintf(stderr, "Erro: ROM '%s': %s\n", roms[r].c_str(), erro.c_str());
+            continue;
+        }
+        // A instância 0 vê a mesma entrada do benchmark de uma VM só
+        for (int i = 0; i < instancias; i++) sementes[i] = 0xC8C8C8C8 + i * 0x9E3779B9u;
+
+        std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+        uint64_t feitos = 0;
+        for (uint64_t quadro = 0; feitos < ciclos; quadro++) {
+            for (int i = 0; i < instancias; i++) {
+                int tecla = bench_sortear_tecla(quadro, &sementes[i]);
+                if (tecla == -2) continue;
+                for (int k = 0; k < CHIP8_KEYS; k++) grupo->ProcessarInput(i, k, false);
+                if (tecla >= 0) grupo->ProcessarInput(i, tecla, true);
+            }
+
+            uint64_t n = (quadro + 1) * hz / 60 - quadro * hz / 60;
+            if (n > ciclos - feitos) n = ciclos - feitos;
+            if (grupo->Executar(n) == 0) break;
+            feitos += n;
+            grupo->ProcessarTimers();
+        }
+        double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+        // Ciclos somados de todas as instâncias (as que falharam param antes)
+        uint64_t executados = grupo->ciclos_vetoriais + grupo->ciclos_escalares;
+        int falhas = 0;
+        for (int i = 0; i < instancias; i++) falhas += grupo->Status(i) != VM_OK;
+
+        printf("{\"rom\":\"%s\",\"motor\":\"grupo\",\"instancias\":%d,\"ciclos\":%llu,\"segundos\":%.6f,"
+               "\"instrucoes_por_segundo\":%.0f,\"fracao_lock_step\":%.3f,\"falhas\":%d}\n",
+               bench_nome(roms[r]), instancias, (unsigned long long)executados, segundos,
+               segundos > 0 ? executados / segundos : 0.0,
+               executados ? (double)grupo->ciclos_vetoriais / executados : 0.0, falhas);
+        fflush(stdout);
+
+        total_ciclos += executados;
+        total_segundos += segundos;
+    }
+
+    printf("{\"rom\":\"(total)\",\"motor\":\"grupo\",\"instancias\":%d,\"ciclos\":%llu,\"segundos\":%.6f,"
+           "\"instrucoes_por_segundo\":%.0f}\n",
+           instancias, (unsigned long long)total_ciclos, total_segundos,
+           total_segundos > 0 ? total_ciclos / total_segundos : 0.0);
+
+    delete grupo;
+    return 0;
+}
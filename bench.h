@@ -0,0 +1,26 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "c8vm.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Benchmark de vazão do núcleo: roda cada ROM sem janela e sem limitar a
+// velocidade por 'ciclos' instruções (timers avançam a cada hz/60 ciclos e a
+// entrada é pseudo-aleatória com semente fixa). Imprime uma linha JSON por
+// ROM em stdout; a vazão desconta os ciclos que o motor pulou em esperas
+// ocupadas (campo "ciclos_em_espera"). Falhas da VM (ex: stack overflow) aparecem no campo
+// "status" mas não são erro do benchmark; retorna != 0 só se não puder rodar.
+int Bench_Executar(const std::vector<std::string>& roms, uint64_t ciclos,
+                   const char* nome_motor, int hz, VM_Quirks quirks);
+
+// Mesmo benchmark com 'instancias' cópias de cada ROM em lock-step
+// (GrupoVM), cada uma com sua própria sequência de entrada. Os ciclos e
+// instruções por segundo são somados entre as instâncias.
+int Bench_ExecutarGrupo(const std::vector<std::string>& roms, uint64_t ciclos,
+                        int instancias, int hz, VM_Quirks quirks);
+
+#endif
@@ -0,0 +1,468 @@
+#include "c8analise.h"
+#include "c8decod.h"
+#include "c8ops.h"
+#include <string.h>
+#include <algorithm>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Valor de I na entrada de um bloco durante a propagação
+#define ANALISE_I_NAO_VISTO    -2   // Nenhum predecessor propagou ainda
+#define ANALISE_I_DESCONHECIDO -1   // Depende da execução
+
+#define C8_TIPO_OP(NOME, TIPO) TIPO,
+static const uint8_t analise_tipos[C8_NUM_OPS] = { C8_OPS(C8_TIPO_OP) C8_DESVIO };
+#undef C8_TIPO_OP
+
+static const char* const analise_nomes_saida[] = {
+    "segue", "salto", "chamada", "skip", "indireto", "retorno", "fim"
+};
+
+static const char* const analise_nomes_regiao[] = { "codigo", "dados", "inalcancada" };
+
+static int analise_incremento_i(uint8_t quirks) {
+    C8_DESPACHAR_QUIRKS(quirks, (int)Q::incremento_i);
+}
+
+// Tamanho da instrução em 'pc', como o C8_Pular o vê: F000 NNNN ocupa 4
+// bytes no XO-CHIP
+static int analise_tam_inst(const AnaliseROM& a, uint32_t pc) {
+    return a.extensao >= VM_EXT_XOCHIP && pc + 1 < a.tam_ram && a.RAM[pc] == 0xF0 && a.RAM[pc + 1] == 0x00 ? 4 : 2;
+}
+
+// Instruções de extensões que o perfil não tem viram OP_INVALIDA, como na execução
+static OpDecodificada analise_decodificar(const AnaliseROM& a, uint32_t pc) {
+    OpDecodificada d = C8_Decodificar((a.RAM[pc] << 8) | a.RAM[pc + 1]);
+    if (C8_ExtensaoOp(d.op) > a.extensao) d.op = OP_INVALIDA;
+    return d;
+}
+
+// Bytes ocupados pela instrução já decodificada. Um F000 sem espaço para
+// o endereço antes do fim da memória fica com 2 (a análise não segue a
+// volta do PC para o início).
+static int analise_tam_op(const AnaliseROM& a, uint32_t pc, const OpDecodificada& d) {
+    return d.op == OP_F000 && pc + 3 < a.tam_ram ? 4 : 2;
+}
+
+static void analise_marcar(AnaliseROM* a, int32_t inicio, uint32_t tam, uint8_t classe) {
+    // Endereços de dados dão a volta no fim da memória, como na VM (C8_Endereco)
+    for (uint32_t k = 0; k < tam; k++) a->classe[(inicio + k) & (a->tam_ram - 1)] |= classe;
+}
+
+// Sucessores da instrução em 'pc' no fluxo de controle. Retorna a saída
+// do bloco se a instrução termina um bloco (tipo != C8_SEQ).
+static AnaliseSaida analise_sucessores(const AnaliseROM& a, uint32_t pc, const OpDecodificada& d,
+                                       std::vector<uint16_t>& suc) {
+    suc.clear();
+    uint32_t prox = pc + 2;
+    switch (d.op) {
+        case OP_1NNN:
+            suc.push_back(d.NNN);
+            return ANALISE_SALTO;
+        case OP_2NNN:
+            suc.push_back(d.NNN);
+            suc.push_back(prox);
+            return ANALISE_CHAMADA;
+        case OP_3XNN: case OP_4XNN: case OP_5XY0: case OP_9XY0: case OP_EX9E: case OP_EXA1:
+            suc.push_back(prox);
+            if (prox < a.tam_ram) suc.push_back(prox + analise_tam_inst(a, prox));
+            return ANALISE_SKIP;
+        case OP_BNNN:
+            return ANALISE_INDIRETO;
+        case OP_00EE:
+            return ANALISE_RETORNO;
+        case OP_00FD:
+        case OP_INVALIDA:
+            return ANALISE_FIM;
+        case OP_F000:
+            if (pc + 3 >= a.tam_ram) return ANALISE_FIM;
+            suc.push_back(pc + 4);
+            return ANALISE_SEGUE;
+        default:
+            suc.push_back(prox);
+            return ANALISE_SEGUE;
+    }
+}
+
+size_t AnaliseROM::AutoModificacoes() const {
+    size_t n = 0;
+    for (size_t i = 0; i < this->escritas.size(); i++) {
+        if (this->escritas[i].sobre_codigo || !this->escritas[i].alvo_conhecido) n++;
+    }
+    return n;
+}
+
+void Analise_ROM(const ImagemROM& img, VM_Quirks quirks, AnaliseROM* a) {
+    a->pc_inicial = img.pc_inicial;
+    a->tamanho = img.tamanho;
+    a->tam_ram = VM_TamRAMQuirks(quirks);
+    a->quirks = quirks;
+    a->extensao = VM_ExtensaoQuirks(quirks);
+    a->RAM.assign(img.RAM.begin(), img.RAM.end());
+    a->RAM.resize(a->tam_ram, 0);
+    a->classe.assign(a->tam_ram, 0);
+    a->blocos.clear();
+    a->sub_rotinas.clear();
+    a->escritas.clear();
+    a->regioes.clear();
+    a->invalidas.clear();
+    a->instrucoes = 0;
+
+    // 1) Instruções alcançáveis a partir do PC inicial, e onde começam os
+    //    blocos: no PC inicial, nos destinos de desvio e depois de qualquer
+    //    instrução que termina um bloco
+    std::vector<uint8_t> visitada(a->tam_ram, 0);
+    std::vector<uint8_t> lider(a->tam_ram, 0);
+    std::vector<uint16_t> pendentes;
+    std::vector<uint16_t> suc;
+    pendentes.push_back(a->pc_inicial);
+    lider[a->pc_inicial] = 1;
+
+    while (!pendentes.empty()) {
+        uint32_t pc = pendentes.back();
+        pendentes.pop_back();
+        if (pc + 1 >= a->tam_ram || visitada[pc]) continue;
+        visitada[pc] = 1;
+        a->instrucoes++;
+
+        OpDecodificada d = analise_decodificar(*a, pc);
+        int tam = analise_tam_op(*a, pc, d);
+        a->classe[pc] |= ANALISE_CODIGO;
+        analise_marcar(a, pc + 1, tam - 1, ANALISE_OPERANDO);
+        if (d.op == OP_INVALIDA) a->invalidas.push_back(pc);
+        if (d.op == OP_2NNN) a->sub_rotinas.push_back(d.NNN);
+
+        analise_sucessores(*a, pc, d, suc);
+        bool fim_bloco = analise_tipos[d.op] != C8_SEQ;
+        for (size_t k = 0; k < suc.size(); k++) {
+            if (suc[k] >= a->tam_ram) continue;
+            // Destino de desvio (não a instrução seguinte de uma SEQ)
+            if (fim_bloco || suc[k] != pc + tam) lider[suc[k]] = 1;
+            pendentes.push_back(suc[k]);
+        }
+    }
+
+    std::sort(a->invalidas.begin(), a->invalidas.end());
+    std::sort(a->sub_rotinas.begin(), a->sub_rotinas.end());
+    a->sub_rotinas.erase(std::unique(a->sub_rotinas.begin(), a->sub_rotinas.end()), a->sub_rotinas.end());
+
+    // 2) Blocos básicos: de cada líder até a primeira instrução que termina
+    //    um bloco ou até o próximo líder
+    std::vector<int> bloco_em(a->tam_ram, -1);
+    for (uint32_t ini = 0; ini < a->tam_ram; ini++) {
+        if (!lider[ini] || !visitada[ini]) continue;
+
+        BlocoAnalise b;
+        b.inicio = ini;
+        b.saida = ANALISE_FIM;
+        uint32_t pc = ini;
+        for (;;) {
+            OpDecodificada d = analise_decodificar(*a, pc);
+            int tam = analise_tam_op(*a, pc, d);
+            AnaliseSaida saida = analise_sucessores(*a, pc, d, b.sucessores);
+            pc += tam;
+            if (analise_tipos[d.op] != C8_SEQ) {
+                b.saida = saida;
+                break;
+            }
+            if (pc + 1 >= a->tam_ram) {
+                // Fim da memória: a análise não segue a volta do PC
+                b.sucessores.clear();
+                break;
+            }
+            if (lider[pc]) {
+                b.saida = ANALISE_SEGUE;
+                break;
+            }
+        }
+        b.fim = pc;
+        // Destinos fora da RAM não são blocos (a busca falha)
+        for (size_t k = b.sucessores.size(); k-- > 0;) {
+            if ((uint32_t)b.sucessores[k] + 1 >= a->tam_ram) b.sucessores.erase(b.sucessores.begin() + k);
+        }
+        bloco_em[ini] = (int)a->blocos.size();
+        a->blocos.push_back(b);
+    }
+
+    // 3) Propagação de I entre os blocos até estabilizar. Cada bloco só
+    //    muda de "não visto" para um valor e de um valor para
+    //    "desconhecido", então a propagação termina.
+    int incremento = analise_incremento_i(quirks);
+    std::vector<int32_t> i_entrada(a->blocos.size(), ANALISE_I_NAO_VISTO);
+    std::vector<uint8_t> na_fila(a->blocos.size(), 0);
+    std::vector<int> fila;
+    if (bloco_em[a->pc_inicial] >= 0) {
+        i_entrada[bloco_em[a->pc_inicial]] = ANALISE_I_DESCONHECIDO;
+        fila.push_back(bloco_em[a->pc_inicial]);
+        na_fila[bloco_em[a->pc_inicial]] = 1;
+    }
+
+    // Efeito de uma instrução em I
+    #define ANALISE_TRANSFERIR_I(d, pc, i)                                               \
+        switch ((d).op) {                                                                \
+            case OP_ANNN: (i) = (d).NNN; break;                                          \
+            case OP_F000:                                                                \
+                (i) = (pc) + 3 < a->tam_ram ? (a->RAM[(pc) + 2] << 8) | a->RAM[(pc) + 3]      \
+                                            : ANALISE_I_DESCONHECIDO;                    \
+                break;                                                                   \
+            case OP_FX1E: case OP_FX29: case OP_FX30: (i) = ANALISE_I_DESCONHECIDO; break; \
+            case OP_FX55: case OP_FX65:                                                  \
+                if ((i) >= 0 && incremento == C8_I_MAIS_X)  (i) = ((i) + (d).X) & 0xFFFF;     \
+                if ((i) >= 0 && incremento == C8_I_MAIS_X1) (i) = ((i) + (d).X + 1) & 0xFFFF; \
+                break;                                                                   \
+            default: break;                                                              \
+        }
+
+    while (!fila.empty()) {
+        int ib = fila.back();
+        fila.pop_back();
+        na_fila[ib] = 0;
+        const BlocoAnalise& b = a->blocos[ib];
+
+        int32_t i = i_entrada[ib];
+        for (uint32_t pc = b.inicio; pc < b.fim;) {
+            OpDecodificada d = analise_decodificar(*a, pc);
+            ANALISE_TRANSFERIR_I(d, pc, i)
+            pc += analise_tam_op(*a, pc, d);
+        }
+
+        for (size_t k = 0; k < b.sucessores.size(); k++) {
+            int is = bloco_em[b.sucessores[k]];
+            if (is < 0) continue;
+            // A sub-rotina pode mudar I antes de voltar
+            int32_t v = (b.saida == ANALISE_CHAMADA && k == 1) ? ANALISE_I_DESCONHECIDO : i;
+            int32_t antes = i_entrada[is];
+            if (antes == ANALISE_I_NAO_VISTO) i_entrada[is] = v;
+            else if (antes != v) i_entrada[is] = ANALISE_I_DESCONHECIDO;
+            if (i_entrada[is] != antes && !na_fila[is]) {
+                fila.push_back(is);
+                na_fila[is] = 1;
+            }
+        }
+    }
+
+    // 4) Com o I de cada instrução: dados lidos, escritos e apontados
+    for (size_t ib = 0; ib < a->blocos.size(); ib++) {
+        const BlocoAnalise& b = a->blocos[ib];
+        int32_t i = i_entrada[ib];
+        for (uint32_t pc = b.inicio; pc < b.fim;) {
+            OpDecodificada d = analise_decodificar(*a, pc);
+            int n_xy = (d.X <= d.Y ? d.Y - d.X : d.X - d.Y) + 1;
+            bool conhecido = i >= 0;
+            switch (d.op) {
+                case OP_DXYN:
+                    // Só o primeiro plano: os planos desenhados dependem do FN01
+                    if (conhecido) analise_marcar(a, i, d.N ? d.N : 32, ANALISE_LIDO);
+                    break;
+                case OP_FX65: if (conhecido) analise_marcar(a, i, d.X + 1, ANALISE_LIDO); break;
+                case OP_5XY3: if (conhecido) analise_marcar(a, i, n_xy, ANALISE_LIDO); break;
+                case OP_F002: if (conhecido) analise_marcar(a, i, 16, ANALISE_LIDO); break;
+                case OP_FX33: case OP_FX55: case OP_5XY2: {
+                    EscritaAnalise e;
+                    e.pc = pc;
+                    e.alvo_conhecido = conhecido;
+                    e.inicio = conhecido ? (uint16_t)(i & (a->tam_ram - 1)) : 0;
+                    e.tam = d.op == OP_FX33 ? 3 : d.op == OP_5XY2 ? n_xy : d.X + 1;
+                    e.sobre_codigo = false;
+                    if (conhecido) analise_marcar(a, i, e.tam, ANALISE_ESCRITO);
+                    a->escritas.push_back(e);
+                    break;
+                }
+                default: break;
+            }
+            ANALISE_TRANSFERIR_I(d, pc, i)
+            if ((d.op == OP_ANNN || d.op == OP_F000) && (uint32_t)i < a->tam_ram) a->classe[i] |= ANALISE_APONTADO;
+            pc += analise_tam_op(*a, pc, d);
+        }
+    }
+    #undef ANALISE_TRANSFERIR_I
+
+    for (size_t k = 0; k < a->escritas.size(); k++) {
+        EscritaAnalise& e = a->escritas[k];
+        for (uint32_t j = 0; e.alvo_conhecido && j < e.tam; j++) {
+            if (a->classe[(e.inicio + j) & (a->tam_ram - 1)] & (ANALISE_CODIGO | ANALISE_OPERANDO)) e.sobre_codigo = true;
+        }
+    }
+
+    // 5) Regiões da ROM: trechos de código e, entre eles, dados (se algum
+    //    byte do trecho é referenciado) ou inalcançáveis
+    uint32_t fim_rom = (uint32_t)a->pc_inicial + a->tamanho;
+    for (uint32_t p = a->pc_inicial; p < fim_rom;) {
+        bool codigo = (a->classe[p] & (ANALISE_CODIGO | ANALISE_OPERANDO)) != 0;
+        bool referenciado = false;
+        uint32_t q = p;
+        while (q < fim_rom && ((a->classe[q] & (ANALISE_CODIGO | ANALISE_OPERANDO)) != 0) == codigo) {
+            if (a->classe[q] & (ANALISE_LIDO | ANALISE_ESCRITO | ANALISE_APONTADO)) referenciado = true;
+            q++;
+        }
+        RegiaoAnalise r;
+        r.inicio = p;
+        r.tam = q - p;
+        r.tipo = codigo ? ANALISE_REGIAO_CODIGO : referenciado ? ANALISE_REGIAO_DADOS : ANALISE_REGIAO_INALCANCADA;
+        a->regioes.push_back(r);
+        p = q;
+    }
+}
+
+int Analise_Desmontar(const uint8_t* ram, uint32_t tam_ram, uint16_t pc, char* texto, size_t tam_texto) {
+    if ((uint32_t)pc + 1 >= tam_ram) {
+        snprintf(texto, tam_texto, "(fora da RAM)");
+        return 2;
+    }
+    uint16_t inst = (ram[pc] << 8) | ram[pc + 1];
+    OpDecodificada d = C8_Decodificar(inst);
+    int x = d.X, y = d.Y, n = d.N, nn = d.NN, nnn = d.NNN;
+
+    switch (d.op) {
+        case OP_0NNN: snprintf(texto, tam_texto, "SYS 0x%03X", nnn); break;
+        case OP_00E0: snprintf(texto, tam_texto, "CLS"); break;
+        case OP_00EE: snprintf(texto, tam_texto, "RET"); break;
+        case OP_00CN: snprintf(texto, tam_texto, "SCD %d", n); break;
+        case OP_00DN: snprintf(texto, tam_texto, "SCU %d", n); break;
+        case OP_00FB: snprintf(texto, tam_texto, "SCR"); break;
+        case OP_00FC: snprintf(texto, tam_texto, "SCL"); break;
+        case OP_00FD: snprintf(texto, tam_texto, "EXIT"); break;
+        case OP_00FE: snprintf(texto, tam_texto, "LOW"); break;
+        case OP_00FF: snprintf(texto, tam_texto, "HIGH"); break;
+        case OP_1NNN: snprintf(texto, tam_texto, "JP 0x%03X", nnn); break;
+        case OP_2NNN: snprintf(texto, tam_texto, "CALL 0x%03X", nnn); break;
+        case OP_3XNN: snprintf(texto, tam_texto, "SE V%X, 0x%02X", x, nn); break;
+        case OP_4XNN: snprintf(texto, tam_texto, "SNE V%X, 0x%02X", x, nn); break;
+        case OP_5XY0: snprintf(texto, tam_texto, "SE V%X, V%X", x, y); break;
+        case OP_5XY2: snprintf(texto, tam_texto, "SAVE V%X-V%X", x, y); break;
+        case OP_5XY3: snprintf(texto, tam_texto, "LOAD V%X-V%X", x, y); break;
+        case OP_6XNN: snprintf(texto, tam_texto, "LD V%X, 0x%02X", x, nn); break;
+        case OP_7XNN: snprintf(texto, tam_texto, "ADD V%X, 0x%02X", x, nn); break;
+        case OP_8XY0: snprintf(texto, tam_texto, "LD V%X, V%X", x, y); break;
+        case OP_8XY1: snprintf(texto, tam_texto, "OR V%X, V%X", x, y); break;
+        case OP_8XY2: snprintf(texto, tam_texto, "AND V%X, V%X", x, y); break;
+        case OP_8XY3: snprintf(texto, tam_texto, "XOR V%X, V%X", x, y); break;
+        case OP_8XY4: snprintf(texto, tam_texto, "ADD V%X, V%X", x, y); break;
+        case OP_8XY5: snprintf(texto, tam_texto, "SUB V%X, V%X", x, y); break;
+        case OP_8XY6: snprintf(texto, tam_texto, "SHR V%X, V%X", x, y); break;
+        case OP_8XY7: snprintf(texto, tam_texto, "SUBN V%X, V%X", x, y); break;
+        case OP_8XYE: snprintf(texto, tam_texto, "SHL V%X, V%X", x, y); break;
+        case OP_9XY0: snprintf(texto, tam_texto, "SNE V%X, V%X", x, y); break;
+        case OP_ANNN: snprintf(texto, tam_texto, "LD I, 0x%03X", nnn); break;
+        case OP_BNNN: snprintf(texto, tam_texto, "JP V0, 0x%03X", nnn); break;
+        case OP_CXNN: snprintf(texto, tam_texto, "RND V%X, 0x%02X", x, nn); break;
+        case OP_DXYN: snprintf(texto, tam_texto, "DRW V%X, V%X, %d", x, y, n); break;
+        case OP_EX9E: snprintf(texto, tam_texto, "SKP V%X", x); break;
+        case OP_EXA1: snprintf(texto, tam_texto, "SKNP V%X", x); break;
+        case OP_F000:
+            if ((uint32_t)pc + 3 >= tam_ram) {
+                snprintf(texto, tam_texto, "LD I, (fora da RAM)");
+                return 2;
+            }
+            snprintf(texto, tam_texto, "LD I, 0x%04X", (ram[pc + 2] << 8) | ram[pc + 3]);
+            return 4;
+        case OP_FN01: snprintf(texto, tam_texto, "PLANE %d", x); break;
+        case OP_F002: snprintf(texto, tam_texto, "AUDIO"); break;
+        case OP_FX07: snprintf(texto, tam_texto, "LD V%X, DT", x); break;
+        case OP_FX0A: snprintf(texto, tam_texto, "LD V%X, K", x); break;
+        case OP_FX15: snprintf(texto, tam_texto, "LD DT, V%X", x); break;
+        case OP_FX18: snprintf(texto, tam_texto, "LD ST, V%X", x); break;
+        case OP_FX1E: snprintf(texto, tam_texto, "ADD I, V%X", x); break;
+        case OP_FX29: snprintf(texto, tam_texto, "LD F, V%X", x); break;
+        case OP_FX30: snprintf(texto, tam_texto, "LD HF, V%X", x); break;
+        case OP_FX33: snprintf(texto, tam_texto, "LD B, V%X", x); break;
+        case OP_FX3A: snprintf(texto, tam_texto, "PITCH V%X", x); break;
+        case OP_FX55: snprintf(texto, tam_texto, "LD [I], V%X", x); break;
+        case OP_FX65: snprintf(texto, tam_texto, "LD V%X, [I]", x); break;
+        case OP_FX75: snprintf(texto, tam_texto, "LD R, V%X", x); break;
+        case OP_FX85: snprintf(texto, tam_texto, "LD V%X, R", x); break;
+        default:      snprintf(texto, tam_texto, "DW 0x%04X", inst); break;
+    }
+    return 2;
+}
+
+void Analise_EscreverJSON(const AnaliseROM& a, const char* nome, FILE* saida) {
+    char texto[64];
+
+    fprintf(saida, "{\n  \"rom\": \"");
+    for (const char* c = nome; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', saida);
+        if ((unsigned char)*c >= 0x20) fputc(*c, saida);
+    }
+    fprintf(saida, "\",\n  \"pc_inicial\": \"0x%03X\", \"tamanho\": %u, \"tam_ram\": %u, \"quirks\": \"%s\",\n",
+            a.pc_inicial, a.tamanho, a.tam_ram, VM_NomeQuirks((VM_Quirks)a.quirks));
+    fprintf(saida, "  \"instrucoes\": %u, \"blocos_total\": %zu, \"invalidas\": %zu, \"auto_modificacoes\": %zu,\n",
+            a.instrucoes, a.blocos.size(), a.invalidas.size(), a.AutoModificacoes());
+
+    fprintf(saida, "  \"regioes\": [");
+    for (size_t k = 0; k < a.regioes.size(); k++) {
+        const RegiaoAnalise& r = a.regioes[k];
+        fprintf(saida, "%s\n    {\"inicio\": \"0x%03X\", \"tam\": %u, \"tipo\": \"%s\"}",
+                k ? "," : "", r.inicio, r.tam, analise_nomes_regiao[r.tipo]);
+    }
+    fprintf(saida, "%s],\n", a.regioes.empty() ? "" : "\n  ");
+
+    fprintf(saida, "  \"sub_rotinas\": [");
+    for (size_t k = 0; k < a.sub_rotinas.size(); k++) fprintf(saida, "%s\"0x%03X\"", k ? ", " : "", a.sub_rotinas[k]);
+    fprintf(saida, "],\n");
+
+    fprintf(saida, "  \"enderecos_invalidos\": [");
+    for (size_t k = 0; k < a.invalidas.size(); k++) fprintf(saida, "%s\"0x%03X\"", k ? ", " : "", a.invalidas[k]);
+    fprintf(saida, "],\n");
+
+    fprintf(saida, "  \"escritas\": [");
+    for (size_t k = 0; k < a.escritas.size(); k++) {
+        const EscritaAnalise& e = a.escritas[k];
+        fprintf(saida, "%s\n    {\"pc\": \"0x%03X\", ", k ? "," : "", e.pc);
+        if (e.alvo_conhecido) fprintf(saida, "\"inicio\": \"0x%03X\", ", e.inicio);
+        else fprintf(saida, "\"inicio\": null, ");
+        fprintf(saida, "\"tam\": %u, \"sobre_codigo\": %s}", e.tam, e.sobre_codigo ? "true" : "false");
+    }
+    fprintf(saida, "%s],\n", a.escritas.empty() ? "" : "\n  ");
+
+    fprintf(saida, "  \"blocos\": [");
+    for (size_t k = 0; k < a.blocos.size(); k++) {
+        const BlocoAnalise& b = a.blocos[k];
+        fprintf(saida, "%s\n    {\"inicio\": \"0x%03X\", \"fim\": \"0x%03X\", \"saida\": \"%s\", \"sucessores\": [",
+                k ? "," : "", b.inicio, b.fim, analise_nomes_saida[b.saida]);
+        for (size_t s = 0; s < b.sucessores.size(); s++) fprintf(saida, "%s\"0x%03X\"", s ? ", " : "", b.sucessores[s]);
+        fprintf(saida, "],\n     \"codigo\": [");
+        for (uint32_t pc = b.inicio; pc < b.fim;) {
+            int tam = Analise_Desmontar(a.RAM.data(), a.tam_ram, pc, texto, sizeof(texto));
+            fprintf(saida, "%s\"0x%03X: %s\"", pc != b.inicio ? ", " : "", pc, texto);
+            pc += tam;
+        }
+        fprintf(saida, "]}");
+    }
+    fprintf(saida, "%s]\n}\n", a.blocos.empty() ? "" : "\n  ");
+}
+
+void Analise_EscreverDOT(const AnaliseROM& a, const char* nome, FILE* saida) {
+    char texto[64];
+
+    fprintf(saida, "digraph \"");
+    for (const char* c = nome; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', saida);
+        fputc(*c, saida);
+    }
+    fprintf(saida, "\" {\n  node [shape=box, fontname=\"monospace\"];\n");
+
+    // Um nó por bloco com a desmontagem; sub-rotinas em destaque
+    for (size_t k = 0; k < a.blocos.size(); k++) {
+        const BlocoAnalise& b = a.blocos[k];
+        bool sub = std::binary_search(a.sub_rotinas.begin(), a.sub_rotinas.end(), b.inicio);
+        fprintf(saida, "  b%03X [label=\"", b.inicio);
+        for (uint32_t pc = b.inicio; pc < b.fim;) {
+            int tam = Analise_Desmontar(a.RAM.data(), a.tam_ram, pc, texto, sizeof(texto));
+            fprintf(saida, "%03X: %s\\l", pc, texto);
+            pc += tam;
+        }
+        fprintf(saida, "\"%s%s];\n", sub ? ", style=bold" : "",
+                b.saida == ANALISE_INDIRETO || b.saida == ANALISE_FIM ? ", color=red" : "");
+    }
+
+    // Arestas: a de retorno de uma chamada e a de um skip que pula ficam tracejadas
+    for (size_t k = 0; k < a.blocos.size(); k++) {
+        const BlocoAnalise& b = a.blocos[k];
+        for (size_t s = 0; s < b.sucessores.size(); s++) {
+            bool tracejada = (b.saida == ANALISE_CHAMADA || b.saida == ANALISE_SKIP) && s == 1;
+            fprintf(saida, "  b%03X -> b%03X%s;\n", b.inicio, b.sucessores[s], tracejada ? " [style=dashed]" : "");
+        }
+    }
+    fprintf(saida, "}\n");
+}
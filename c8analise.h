@@ -0,0 +1,109 @@
+#ifndef C8ANALISE_H
+#define C8ANALISE_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <vector>
+#include "c8vm.h"
+#include "c8rom.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Análise estática de uma ROM: desmonta o código a partir do endereço de
+// carga seguindo os desvios (1NNN, 2NNN, skips), monta o grafo de fluxo de
+// controle em blocos básicos e classifica cada byte da ROM em código, dados
+// ou inalcançável. Serve para auditar ROMs (código auto-modificável,
+// instruções inválidas alcançáveis, saltos indiretos) e para preaquecer os
+// motores (Motor::Preaquecer) antes do primeiro quadro.
+//
+// Onde o resultado depende da execução a análise é conservadora: o BNNN
+// (salto indireto) não tem sucessores conhecidos, e o código alcançado só
+// por ele aparece como inalcançável. O I é seguido entre os blocos (ANNN,
+// F000 NNNN, FX55/FX65 conforme o perfil de quirks); onde ele não é
+// conhecido, leituras e escritas na RAM ficam sem alvo.
+
+// Classificação de cada byte da RAM (bits: um byte pode ser código e dado)
+#define ANALISE_CODIGO    0x01  // Primeiro byte de uma instrução alcançável
+#define ANALISE_OPERANDO  0x02  // Demais bytes de uma instrução alcançável
+#define ANALISE_LIDO      0x04  // Lido como dado (DXYN, FX65, 5XY3, F002)
+#define ANALISE_ESCRITO   0x08  // Escrito por FX33/FX55/5XY2
+#define ANALISE_APONTADO  0x10  // Carregado em I por ANNN ou F000 NNNN
+
+// Como um bloco básico termina
+enum AnaliseSaida {
+    ANALISE_SEGUE,      // Na próxima instrução (começo de outro bloco, escrita, FX0A)
+    ANALISE_SALTO,      // 1NNN
+    ANALISE_CHAMADA,    // 2NNN (o retorno volta para a instrução seguinte)
+    ANALISE_SKIP,       // 3XNN, 4XNN, 5XY0, 9XY0, EX9E, EXA1
+    ANALISE_INDIRETO,   // BNNN: destino depende dos registradores
+    ANALISE_RETORNO,    // 00EE
+    ANALISE_FIM,        // 00FD, instrução inválida ou fim da RAM
+};
+
+// Blocos terminam como os de MotorBlocos (em instrução que pode desviar ou
+// escrever na RAM) ou onde começa outro bloco
+struct BlocoAnalise {
+    uint16_t inicio;
+    uint16_t fim;                      // Depois da última instrução
+    uint8_t saida;                     // AnaliseSaida
+    std::vector<uint16_t> sucessores;  // Início dos blocos seguintes
+};
+
+// Escrita na RAM (FX33/FX55/5XY2)
+struct EscritaAnalise {
+    uint16_t pc;
+    bool alvo_conhecido;   // false = I depende da execução
+    uint16_t inicio;       // Bytes escritos, se o alvo é conhecido
+    uint16_t tam;
+    bool sobre_codigo;     // Escreve em instrução alcançável (auto-modificação)
+};
+
+// Trecho contínuo da ROM com a mesma classificação
+enum AnaliseTipoRegiao {
+    ANALISE_REGIAO_CODIGO,
+    ANALISE_REGIAO_DADOS,         // Algum byte é apontado, lido ou escrito
+    ANALISE_REGIAO_INALCANCADA    // Nem executado nem referenciado
+};
+
+struct RegiaoAnalise {
+    uint16_t inicio;
+    uint32_t tam;
+    uint8_t tipo;   // AnaliseTipoRegiao
+};
+
+struct AnaliseROM {
+    uint16_t pc_inicial;
+    uint32_t tamanho;      // Bytes da ROM
+    uint32_t tam_ram;
+    uint8_t quirks;
+    uint8_t extensao;      // VM_Extensao do perfil: as outras instruções são inválidas
+    std::vector<uint8_t> RAM; // RAM inicial analisada: a da ImagemROM, zerada até tam_ram
+
+    std::vector<uint8_t> classe;              // ANALISE_* de cada byte da RAM
+    std::vector<BlocoAnalise> blocos;         // Em ordem de endereço
+    std::vector<uint16_t> sub_rotinas;        // Destinos de 2NNN
+    std::vector<EscritaAnalise> escritas;
+    std::vector<RegiaoAnalise> regioes;       // Cobrem a ROM inteira
+    std::vector<uint16_t> invalidas;          // Instruções inválidas alcançáveis
+    uint32_t instrucoes;                      // Instruções alcançáveis
+
+    // Escritas sobre código ou com alvo desconhecido
+    size_t AutoModificacoes() const;
+};
+
+// Analisa a ROM já carregada na imagem, com a RAM do perfil 'quirks'. Se
+// a imagem não couber no perfil (VM_CabeNoPerfil), só a parte que cabe é
+// analisada: confira antes.
+void Analise_ROM(const ImagemROM& img, VM_Quirks quirks, AnaliseROM* a);
+
+// Texto da instrução em 'pc' (ex: "LD V1, 0x40"). O F000 NNNN usa os dois
+// bytes seguintes. Retorna o tamanho da instrução (2 ou 4).
+int Analise_Desmontar(const uint8_t* ram, uint32_t tam_ram, uint16_t pc, char* texto, size_t tam_texto);
+
+// Exportação: JSON com blocos, desmontagem, sub-rotinas, escritas e regiões,
+// ou grafo no formato DOT (Graphviz) com um nó por bloco
+void Analise_EscreverJSON(const AnaliseROM& a, const char* nome, FILE* saida);
+void Analise_EscreverDOT(const AnaliseROM& a, const char* nome, FILE* saida);
+
+#endif
@@ -0,0 +1,134 @@
+#include "c8aot.h"
+#include "c8ops.h"
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Na inicialização estática do fonte gerado: a lista precisa existir antes
+// de qualquer variável global (ordem entre unidades de tradução)
+static std::vector<const ProgramaAOT*>& aot_programas() {
+    static std::vector<const ProgramaAOT*> programas;
+    return programas;
+}
+
+bool AOT_Registrar(const ProgramaAOT* programa) {
+    aot_programas().push_back(programa);
+    return true;
+}
+
+size_t AOT_NumProgramas() {
+    return aot_programas().size();
+}
+
+static bool aot_bloco_igual(const ProgramaAOT* p, const BlocoAOT& b, const VM& vm) {
+    return memcmp(vm.RAM + b.inicio, p->bytes + (b.inicio - p->base), b.fim - b.inicio) == 0;
+}
+
+MotorAOT::MotorAOT() {
+    this->programa = NULL;
+    this->vm_atual = NULL;
+    this->quirks_atual = VM_QUIRKS_PADRAO;
+    this->selecionar = true;
+}
+
+// Escolhe o programa com mais blocos iguais à RAM da VM (do mesmo perfil
+// e tamanho de RAM) e marca quais blocos dele podem ser usados
+void MotorAOT::Selecionar(const VM& vm) {
+    const std::vector<const ProgramaAOT*>& programas = aot_programas();
+    this->programa = NULL;
+    uint32_t melhor = 0;
+    for (size_t k = 0; k < programas.size(); k++) {
+        const ProgramaAOT* p = programas[k];
+        if (p->quirks != vm.quirks || p->tam_ram != vm.tam_ram) continue;
+        uint32_t iguais = 0;
+        for (uint32_t i = 0; i < p->num_blocos; i++) iguais += aot_bloco_igual(p, p->blocos[i], vm);
+        if (iguais > melhor) {
+            melhor = iguais;
+            this->programa = p;
+        }
+    }
+
+    EntradaAOT nenhuma = { -1, 0 };
+    this->entrada_em.assign(vm.tam_ram, nenhuma);
+    this->compilado.assign(vm.tam_ram, 0);
+    this->valido.clear();
+    if (this->programa != NULL) {
+        const ProgramaAOT* p = this->programa;
+        this->valido.resize(p->num_blocos);
+        bool xochip = VM_ExtensaoQuirks((VM_Quirks)p->quirks) == VM_EXT_XOCHIP;
+        for (uint32_t i = 0; i < p->num_blocos; i++) {
+            const BlocoAOT& b = p->blocos[i];
+            this->valido[i] = aot_bloco_igual(p, b, vm);
+            // Mesmo tamanho de instrução da análise: F000 NNNN ocupa 4 bytes
+            // no XO-CHIP
+            uint32_t op = 0;
+            for (uint32_t pc = b.inicio; pc < b.fim; op++) {
+                EntradaAOT e = { (int32_t)i, op };
+                this->entrada_em[pc] = e;
+                const uint8_t* inst = p->bytes + (pc - p->base);
+                pc += xochip && inst[0] == 0xF0 && inst[1] == 0x00 && pc + 3 < p->tam_ram ? 4 : 2;
+            }
+            memset(&this->compilado[b.inicio], 1, b.fim - b.inicio);
+        }
+    }
+
+    this->vm_atual = &vm;
+    this->quirks_atual = vm.quirks;
+    this->selecionar = false;
+}
+
+// Depois de uma escrita na RAM: os blocos que cobrem os bytes escritos
+// continuam valendo se os bytes ainda forem os compilados
+void MotorAOT::Escrita(const VM& vm, uint32_t inicio, uint32_t tam) {
+    bool toca = false;
+    for (uint32_t a = inicio; a < inicio + tam && a < this->compilado.size(); a++) {
+        if (this->compilado[a]) toca = true;
+    }
+    if (!toca) return;
+
+    const ProgramaAOT* p = this->programa;
+    for (uint32_t i = 0; i < p->num_blocos; i++) {
+        const BlocoAOT& b = p->blocos[i];
+        if (b.inicio < inicio + tam && inicio < b.fim) this->valido[i] = aot_bloco_igual(p, b, vm);
+    }
+}
+
+VM_Status MotorAOT::Executar(VM& vm, uint64_t ciclos) {
+    if (this->selecionar || &vm != this->vm_atual || vm.quirks != this->quirks_atual ||
+        this->entrada_em.size() != vm.tam_ram) {
+        this->Selecionar(vm);
+    }
+
+    while (ciclos > 0) {
+        EntradaAOT e = { -1, 0 };
+        if ((uint32_t)vm.PC < this->entrada_em.size()) e = this->entrada_em[vm.PC];
+        uint32_t ini = 0, tam = 0;
+
+        if (e.bloco >= 0 && this->valido[e.bloco]) {
+            const BlocoAOT& b = this->programa->blocos[e.bloco];
+            uint32_t n = b.num_ops - e.op;
+            if (n > ciclos) n = (uint32_t)ciclos;
+            ciclos -= n;
+            VM_Status st = b.funcao(vm, e.op, n, &ini, &tam);
+            if (st != VM_OK) return st;
+            if (tam) this->Escrita(vm, ini, tam);
+            if (b.espera && e.op + n == b.num_ops) {
+                uint64_t pulados = C8_CiclosEmEspera(vm, ciclos);
+                ciclos -= pulados;
+                this->ciclos_em_espera += pulados;
+            }
+            continue;
+        }
+
+        // Interpretador: uma instrução, conferindo os blocos se ela escrever
+        uint32_t pc = C8_Endereco(vm, vm.PC);
+        OpDecodificada d = C8_Decodificar((vm.RAM[pc] << 8) | vm.RAM[C8_Endereco(vm, pc + 1)]);
+        bool escrita = d.op == OP_FX33 || d.op == OP_FX55 || d.op == OP_5XY2;
+        if (escrita) C8_FaixaEscrita(vm, d, &ini, &tam);
+        ciclos--;
+        VM_Status st = vm.VM_ExecutarInstrucao();
+        if (st != VM_OK) return st;
+        if (escrita && this->programa != NULL) this->Escrita(vm, ini, tam);
+    }
+    return VM_OK;
+}
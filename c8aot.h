@@ -0,0 +1,103 @@
+#ifndef C8AOT_H
+#define C8AOT_H
+
+#include <stdint.h>
+#include <vector>
+#include "c8motor.h"
+#include "c8decod.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// ROMs recompiladas para C++ antes da execução ("chip8_headless
+// --recompilar", veja recompilador.h). O fonte gerado tem uma função por
+// bloco básico da análise estática (c8analise.h) que chama as mesmas
+// operações de c8ops.h com os operandos fixos, então o compilador
+// especializa e otimiza o bloco inteiro. Cada ROM gerada vira um
+// ProgramaAOT, registrado ao iniciar o executável.
+//
+// O MotorAOT escolhe o programa cuja ROM está na VM e executa os blocos
+// compilados; o resto (BNNN para fora dos blocos, código escrito por
+// FX33/FX55/5XY2, ROMs sem programa, fim do orçamento de ciclos no meio de
+// um bloco) roda no interpretador. Um bloco só é usado enquanto os bytes
+// dele na RAM são os da recompilação.
+
+// Função de um bloco: executa 'n' instruções dele a partir da de número
+// 'entrada' (0 = início), sem passar do fim do bloco. Assim o orçamento de
+// ciclos pode acabar no meio de um bloco e o próximo Executar continua
+// dali. Se a última escreve na RAM, informa a faixa escrita (para conferir
+// os blocos).
+typedef VM_Status (*FuncaoAOT)(VM& vm, uint32_t entrada, uint32_t n, uint32_t* ini_escrita, uint32_t* tam_escrita);
+
+struct BlocoAOT {
+    uint16_t inicio;
+    uint16_t fim;         // Depois da última instrução
+    uint16_t num_ops;
+    uint8_t espera;       // Termina em 1NNN/FX0A (pode ser uma espera ocupada)
+    FuncaoAOT funcao;
+};
+
+struct ProgramaAOT {
+    const char* nome;
+    uint8_t quirks;             // Perfil com que foi compilado
+    uint32_t tam_ram;
+    uint16_t base;              // Endereço de bytes[0]
+    uint32_t tam_bytes;
+    const uint8_t* bytes;       // RAM esperada de 'base' até o fim do último bloco
+    uint32_t num_blocos;
+    const BlocoAOT* blocos;     // Em ordem de endereço
+};
+
+// Chamado pelo fonte gerado (inicialização estática)
+bool AOT_Registrar(const ProgramaAOT* programa);
+size_t AOT_NumProgramas();
+
+// Motor "aot": só existe no executável com ROMs recompiladas (make aot)
+class MotorAOT : public Motor {
+public:
+    MotorAOT();
+
+    VM_Status Executar(VM& vm, uint64_t ciclos);
+    void InvalidarTudo() { this->selecionar = true; }
+
+private:
+    void Selecionar(const VM& vm);
+    void Escrita(const VM& vm, uint32_t inicio, uint32_t tam);
+
+    // Instrução de um bloco em um endereço da RAM
+    struct EntradaAOT {
+        int32_t bloco;      // -1 = nenhuma
+        uint32_t op;        // Posição da instrução no bloco
+    };
+
+    const ProgramaAOT* programa;    // NULL = só interpretador
+    std::vector<EntradaAOT> entrada_em;
+    std::vector<uint8_t> valido;    // Por bloco: bytes iguais aos compilados
+    std::vector<uint8_t> compilado; // Por byte da RAM: pertence a algum bloco
+    const VM* vm_atual;
+    uint8_t quirks_atual;
+    bool selecionar;
+};
+
+// Macros do fonte gerado (cada instrução é um 'case' da entrada).
+// AOT_OP executa uma instrução como o interpretador (PC já incrementado)
+// e para quando 'n' chega a zero; AOT_OP_ESCRITA é sempre a última do
+// bloco e também informa a faixa da RAM escrita.
+#define AOT_OP(NOME, ENDERECO, X, Y, N, NN, NNN)                             \
+    {                                                                        \
+        static const OpDecodificada d = { OP_##NOME, X, Y, N, NN, NNN };     \
+        vm.PC = (ENDERECO) + 2;                                              \
+        VM_Status st = op_##NOME<Q>(vm, d);                                  \
+        if (st != VM_OK) return st;                                          \
+        if (--n == 0) return VM_OK;                                          \
+    }
+
+#define AOT_OP_ESCRITA(NOME, ENDERECO, X, Y, N, NN, NNN)                     \
+    {                                                                        \
+        static const OpDecodificada d = { OP_##NOME, X, Y, N, NN, NNN };     \
+        vm.PC = (ENDERECO) + 2;                                              \
+        C8_FaixaEscrita(vm, d, ini_escrita, tam_escrita);                    \
+        VM_Status st = op_##NOME<Q>(vm, d);                                  \
+        if (st != VM_OK) return st;                                          \
+    }
+
+#endif
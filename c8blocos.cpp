@@ -0,0 +1,212 @@
+#include "c8blocos.h"
+#include "c8ops.h"
+#include "c8analise.h"
+#include <stddef.h>
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+MotorBlocos::MotorBlocos() {
+    this->vm_atual = NULL;
+    this->quirks_atual = VM_QUIRKS_PADRAO;
+    this->tam_usado = VM_TAM_RAM;
+    this->InvalidarTudo();
+}
+
+void MotorBlocos::InvalidarTudo() {
+    // Só a parte da RAM que as VMs executadas usam (4KB fora do XO-CHIP)
+    memset(this->bloco_em, 0, this->tam_usado * sizeof(Bloco));
+    memset(this->traduzido, 0, this->tam_usado);
+    this->tam_usado = 0;
+    this->ops.clear();
+    this->pendentes.clear();
+}
+
+void MotorBlocos::Invalidar(uint32_t inicio, uint32_t tam) {
+    // Escrever em dados (o caso comum) não custa nada. Se a escrita pegar
+    // código traduzido, descarta tudo: código auto-modificável é raro e
+    // assim não é preciso saber quais blocos cobrem cada endereço.
+    for (uint32_t a = inicio; a < inicio + tam && a < VM_TAM_RAM; a++) {
+        if (this->traduzido[a]) {
+            this->InvalidarTudo();
+            return;
+        }
+    }
+}
+
+// Decodifica a partir de 'pc' até a primeira instrução que pode desviar ou
+// escrever na RAM (inclusive), ou até BLOCO_MAX_OPS instruções.
+void MotorBlocos::Traduzir(const VM& vm, uint16_t pc, const void* const* rotulos) {
+    Bloco b;
+    b.primeira_op = (uint32_t)this->ops.size();
+    b.num_ops = 0;
+
+    #define C8_TIPO_OP(NOME, TIPO) TIPO,
+    static const uint8_t tipos[C8_NUM_OPS] = { C8_OPS(C8_TIPO_OP) C8_DESVIO };
+    #undef C8_TIPO_OP
+
+    // O bloco para no fim da memória: a instrução seguinte é a do endereço
+    // 0, com o PC mascarado na busca do próximo bloco
+    uint32_t a = pc;
+    while (b.num_ops < BLOCO_MAX_OPS && a < vm.tam_ram) {
+        uint32_t a2 = C8_Endereco(vm, a + 1);
+        OpBloco op;
+        op.d = C8_Decodificar((vm.RAM[a] << 8) | vm.RAM[a2]);
+        op.tratador = rotulos ? rotulos[op.d.op] : NULL;
+        this->ops.push_back(op);
+        b.num_ops++;
+        this->traduzido[a] = this->traduzido[a2] = 1;
+        a += 2;
+        if (tipos[op.d.op] != C8_SEQ) break;
+    }
+
+    // Depois de um InvalidarTudo no meio do Executar (escrita sobre código)
+    // o tam_usado é zero: o próximo InvalidarTudo precisa limpar este bloco
+    if (vm.tam_ram > this->tam_usado) this->tam_usado = vm.tam_ram;
+    this->bloco_em[pc] = b;
+}
+
+void MotorBlocos::Preaquecer(const VM& vm, const AnaliseROM& analise) {
+    if (&vm != this->vm_atual || vm.quirks != this->quirks_atual) {
+        this->InvalidarTudo();
+        this->vm_atual = &vm;
+        this->quirks_atual = vm.quirks;
+    }
+    if (vm.tam_ram > this->tam_usado) this->tam_usado = vm.tam_ram;
+
+    for (size_t k = 0; k < analise.blocos.size(); k++) this->pendentes.push_back(analise.blocos[k].inicio);
+}
+
+// Traduz os blocos pedidos por Preaquecer. Um bloco que parou em
+// BLOCO_MAX_OPS continua no seguinte, que também é traduzido.
+void MotorBlocos::TraduzirPendentes(const VM& vm, const void* const* rotulos) {
+    for (size_t k = 0; k < this->pendentes.size(); k++) {
+        uint32_t pc = this->pendentes[k];
+        while (pc < vm.tam_ram && this->bloco_em[pc].num_ops == 0) {
+            this->Traduzir(vm, pc, rotulos);
+            uint32_t n = this->bloco_em[pc].num_ops;
+            if (n < BLOCO_MAX_OPS) break;
+            pc += 2 * n;
+        }
+    }
+    this->pendentes.clear();
+}
+
+#ifdef DEBUG
+#define C8_RASTRO()                                                              \
+    if (vm.rastro_ativo) {                                                       \
+        VM_EntradaRastro& r = vm.rastro[vm.rastro_pos++ % VM_TAM_RASTRO];        \
+        r.pc = vm.PC;                                                            \
+        r.inst = (vm.RAM[vm.PC] << 8) | vm.RAM[C8_Endereco(vm, vm.PC + 1)];      \
+    }
+#else
+#define C8_RASTRO()
+#endif
+
+// Localiza (ou traduz) o bloco que começa no PC atual. Se sobram menos
+// ciclos que o tamanho do bloco, executa só o começo dele.
+#define C8_PROXIMO_BLOCO()                                                       \
+    if (ciclos == 0) return VM_OK;                                               \
+    vm.PC &= mascara;                                                            \
+    b = &this->bloco_em[vm.PC];                                                  \
+    if (b->num_ops == 0) {                                                       \
+        this->Traduzir(vm, vm.PC, rotulos);                                      \
+        base = this->ops.data();                                                 \
+    }                                                                            \
+    n = b->num_ops < ciclos ? b->num_ops : ciclos;                               \
+    ciclos -= n;                                                                 \
+    op = base + b->primeira_op;                                                  \
+    fim = op + n;
+
+// Executa uma operação do bloco. Só a última operação de um bloco pode
+// desviar ou escrever; depois dela vem a busca do próximo bloco, repetida
+// em cada tratador para que cada um tenha seu próprio salto indireto.
+// Depois de 1NNN/FX0A, uma espera ocupada consome o resto do quadro.
+#define C8_EXECUTAR(NOME, TIPO)                                                  \
+    C8_RASTRO();                                                                 \
+    vm.PC += 2;                                                                  \
+    if (TIPO == C8_ESCRITA) C8_FaixaEscrita(vm, op->d, &ini, &tam);              \
+    st = op_##NOME<Q>(vm, op->d);                                                   \
+    if (st != VM_OK) return st;                                                  \
+    if (TIPO == C8_ESCRITA) {                                                    \
+        this->Invalidar(ini, tam);                                               \
+        base = this->ops.data();                                                 \
+    }                                                                            \
+    if (OP_##NOME == OP_1NNN || OP_##NOME == OP_FX0A) {                          \
+        uint64_t pulados = C8_CiclosEmEspera(vm, ciclos);                        \
+        ciclos -= pulados;                                                       \
+        this->ciclos_em_espera += pulados;                                       \
+    }                                                                            \
+    if (TIPO != C8_SEQ || ++op == fim) {                                         \
+        C8_PROXIMO_BLOCO();                                                      \
+    }
+
+#if defined(__GNUC__)
+// O computed goto é uma extensão do GCC/Clang; o -pedantic reclamaria dele
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+VM_Status MotorBlocos::Executar(VM& vm, uint64_t ciclos) {
+    if (&vm != this->vm_atual || vm.quirks != this->quirks_atual) {
+        this->InvalidarTudo();
+        this->vm_atual = &vm;
+        this->quirks_atual = vm.quirks;
+    }
+    if (vm.tam_ram > this->tam_usado) this->tam_usado = vm.tam_ram;
+
+    C8_DESPACHAR_QUIRKS(vm.quirks, this->ExecutarCom<Q>(vm, ciclos));
+}
+
+// Cada perfil tem sua própria tabela de rótulos
+template<class Q>
+VM_Status MotorBlocos::ExecutarCom(VM& vm, uint64_t ciclos) {
+    // Cópia local do início de 'ops': as escritas da VM na RAM (uint8_t)
+    // obrigariam o compilador a reler o vetor a cada operação
+    const OpBloco* base = this->ops.data();
+    const OpBloco* op;
+    const OpBloco* fim;
+    const Bloco* b;
+    uint64_t n;
+    VM_Status st;
+    uint32_t ini = 0, tam = 0;
+    const uint32_t mascara = vm.tam_ram - 1; // Nenhuma instrução muda o tam_ram
+
+#if defined(__GNUC__)
+    #define C8_ROTULO(NOME, TIPO) &&L_##NOME,
+    static const void* const rotulos[C8_NUM_OPS] = { C8_OPS(C8_ROTULO) &&L_INVALIDA };
+    #undef C8_ROTULO
+#else
+    static const void* const* const rotulos = NULL;
+#endif
+
+    if (!this->pendentes.empty()) {
+        this->TraduzirPendentes(vm, rotulos);
+        base = this->ops.data();
+    }
+
+    C8_PROXIMO_BLOCO();
+
+#if defined(__GNUC__)
+    goto *op->tratador;
+
+    #define C8_ROTULO_OP(NOME, TIPO)  \
+    L_##NOME:                         \
+        C8_EXECUTAR(NOME, TIPO)       \
+        goto *op->tratador;
+    C8_OPS(C8_ROTULO_OP)
+    #undef C8_ROTULO_OP
+#else
+    for (;;) {
+        switch (op->d.op) {
+            #define C8_CASO_OP(NOME, TIPO) case OP_##NOME: { C8_EXECUTAR(NOME, TIPO) } break;
+            C8_OPS(C8_CASO_OP)
+            #undef C8_CASO_OP
+        }
+    }
+#endif
+}
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
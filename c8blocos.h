@@ -0,0 +1,61 @@
+#ifndef C8BLOCOS_H
+#define C8BLOCOS_H
+
+#include <stdint.h>
+#include <vector>
+#include "c8motor.h"
+#include "c8decod.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Tamanho máximo de um bloco traduzido (em instruções)
+#define BLOCO_MAX_OPS 64
+
+// Motor de blocos básicos: traduz trechos sem desvio do código (terminados
+// em 1NNN/2NNN/00EE/BNNN/skips/FX0A ou em escrita na RAM) para uma lista
+// de operações já ligadas ao seu tratador (código "threaded"), indexada
+// pelo PC inicial. Dentro do bloco não há fetch, decodificação nem checagem
+// de limites, só o salto de uma operação para a próxima.
+//
+// Escritas de FX33/FX55 sobre código já traduzido descartam as traduções.
+// Os tratadores são do laço do perfil de quirks da VM: trocar de perfil
+// também descarta tudo.
+class MotorBlocos : public Motor {
+public:
+    MotorBlocos();
+
+    VM_Status Executar(VM& vm, uint64_t ciclos);
+    void InvalidarTudo();
+    void Invalidar(uint32_t inicio, uint32_t tam);
+
+    // Traduz os blocos da análise. Os tratadores são do laço do perfil,
+    // então a tradução em si fica para o começo do próximo Executar.
+    void Preaquecer(const VM& vm, const AnaliseROM& analise);
+
+private:
+    struct OpBloco {
+        const void* tratador;   // Rótulo (ou índice C8Op) que executa a operação
+        OpDecodificada d;
+    };
+
+    struct Bloco {
+        uint32_t primeira_op;   // Índice em 'ops'
+        uint32_t num_ops;       // 0 = endereço ainda não traduzido
+    };
+
+    void Traduzir(const VM& vm, uint16_t pc, const void* const* rotulos);
+    void TraduzirPendentes(const VM& vm, const void* const* rotulos);
+
+    // Laço especializado para um perfil de quirks (veja C8_Quirks)
+    template<class Q> VM_Status ExecutarCom(VM& vm, uint64_t ciclos);
+
+    Bloco bloco_em[VM_TAM_RAM];     // Bloco que começa em cada endereço
+    uint8_t traduzido[VM_TAM_RAM];  // Bytes da RAM que pertencem a algum bloco
+    uint32_t tam_usado;             // Entradas a partir daqui estão vazias
+    std::vector<OpBloco> ops;
+    const VM* vm_atual;
+    uint8_t quirks_atual;           // Perfil dos tratadores ligados em 'ops'
+    std::vector<uint16_t> pendentes; // Inícios de bloco a traduzir (Preaquecer)
+};
+
+#endif
@@ -0,0 +1,147 @@
+#include "c8cache.h"
+#include "c8ops.h"
+#include "c8analise.h"
+#include <stddef.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+MotorCache::MotorCache() {
+    this->vm_atual = NULL;
+    this->tam_usado = VM_TAM_RAM;
+    this->InvalidarTudo();
+}
+
+void MotorCache::InvalidarTudo() {
+    // Só a parte da RAM que as VMs executadas usam (4KB fora do XO-CHIP)
+    for (uint32_t i = 0; i < this->tam_usado; i++) this->cache[i].op = OP_NAO_DECODIFICADA;
+    this->tam_usado = 0;
+}
+
+void MotorCache::Invalidar(uint32_t inicio, uint32_t tam) {
+    // A entrada do endereço 'a' usa os bytes a e a+1, então uma escrita em
+    // 'inicio' também invalida a entrada anterior (a do último byte da
+    // memória, se 'inicio' for 0: o PC dá a volta)
+    int de = inicio > 0 ? inicio - 1 : 0;
+    int ate = inicio + tam;
+    if (ate > VM_TAM_RAM) ate = VM_TAM_RAM;
+    for (int a = de; a < ate; a++) this->cache[a].op = OP_NAO_DECODIFICADA;
+    if (inicio == 0 && this->vm_atual != NULL) this->cache[this->vm_atual->tam_ram - 1].op = OP_NAO_DECODIFICADA;
+}
+
+void MotorCache::Preaquecer(const VM& vm, const AnaliseROM& analise) {
+    if (&vm != this->vm_atual) {
+        this->InvalidarTudo();
+        this->vm_atual = &vm;
+    }
+    if (vm.tam_ram > this->tam_usado) this->tam_usado = vm.tam_ram;
+
+    uint32_t fim = analise.tam_ram < vm.tam_ram ? analise.tam_ram : vm.tam_ram;
+    for (uint32_t pc = 0; pc + 1 < fim; pc++) {
+        if (analise.classe[pc] & ANALISE_CODIGO) this->cache[pc] = C8_Decodificar((vm.RAM[pc] << 8) | vm.RAM[pc + 1]);
+    }
+}
+
+#ifdef DEBUG
+#define C8_RASTRO()                                                              \
+    if (vm.rastro_ativo) {                                                       \
+        VM_EntradaRastro& r = vm.rastro[vm.rastro_pos++ % VM_TAM_RASTRO];        \
+        r.pc = pc;                                                               \
+        r.inst = (vm.RAM[pc] << 8) | vm.RAM[(pc + 1) & mascara];                 \
+    }
+#else
+#define C8_RASTRO()
+#endif
+
+// FETCH: pega a instrução já decodificada do cache (o PC dá a volta no fim
+// da memória, como em VM::VM_Passo)
+#define C8_BUSCAR()                                                              \
+    if (ciclos == 0) return VM_OK;                                               \
+    ciclos--;                                                                    \
+    pc = vm.PC & mascara;                                                        \
+    d = &this->cache[pc];                                                        \
+    C8_RASTRO();                                                                 \
+    vm.PC = pc + 2;
+
+// EXECUTE: mesma semântica do interpretador (c8ops.h). Escritas na RAM
+// invalidam as entradas do cache que cobrem os bytes escritos. Depois de
+// 1NNN/FX0A, uma espera ocupada consome o resto do quadro sem executar.
+#define C8_EXECUTAR(NOME, TIPO)                                                  \
+    if (TIPO == C8_ESCRITA) C8_FaixaEscrita(vm, *d, &ini, &tam);                 \
+    st = op_##NOME<Q>(vm, *d);                                                      \
+    if (st != VM_OK) return st;                                                  \
+    if (TIPO == C8_ESCRITA) this->Invalidar(ini, tam);                           \
+    if (OP_##NOME == OP_1NNN || OP_##NOME == OP_FX0A) {                          \
+        uint64_t pulados = C8_CiclosEmEspera(vm, ciclos);                        \
+        ciclos -= pulados;                                                       \
+        this->ciclos_em_espera += pulados;                                       \
+    }
+
+// DECODE (só na primeira vez): a instrução está em 'pc', o PC já foi incrementado
+#define C8_DECODIFICAR()                                                         \
+    *d = C8_Decodificar((vm.RAM[pc] << 8) | vm.RAM[(pc + 1) & mascara]);
+
+#if defined(__GNUC__)
+// O computed goto é uma extensão do GCC/Clang; o -pedantic reclamaria dele
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wpedantic"
+#endif
+
+VM_Status MotorCache::Executar(VM& vm, uint64_t ciclos) {
+    if (&vm != this->vm_atual) {
+        this->InvalidarTudo();
+        this->vm_atual = &vm;
+    }
+    if (vm.tam_ram > this->tam_usado) this->tam_usado = vm.tam_ram;
+
+    // O cache só guarda a decodificação, que não depende do perfil
+    C8_DESPACHAR_QUIRKS(vm.quirks, this->ExecutarCom<Q>(vm, ciclos));
+}
+
+// Cada perfil tem sua própria tabela de rótulos
+template<class Q>
+VM_Status MotorCache::ExecutarCom(VM& vm, uint64_t ciclos) {
+    OpDecodificada* d;
+    VM_Status st;
+    uint32_t ini = 0, tam = 0;
+    uint32_t pc;
+    const uint32_t mascara = vm.tam_ram - 1; // Nenhuma instrução muda o tam_ram
+
+#if defined(__GNUC__)
+    // Despacho por tabela de rótulos: cada operação salta direto para a próxima
+    #define C8_ROTULO(NOME, TIPO) &&L_##NOME,
+    static void* const rotulos[C8_NUM_OPS] = { C8_OPS(C8_ROTULO) &&L_NAO_DECODIFICADA };
+    #undef C8_ROTULO
+
+    C8_BUSCAR();
+    goto *rotulos[d->op];
+
+    #define C8_ROTULO_OP(NOME, TIPO)  \
+    L_##NOME:                         \
+        C8_EXECUTAR(NOME, TIPO)       \
+        C8_BUSCAR();                  \
+        goto *rotulos[d->op];
+    C8_OPS(C8_ROTULO_OP)
+    #undef C8_ROTULO_OP
+
+L_NAO_DECODIFICADA:
+    C8_DECODIFICAR();
+    goto *rotulos[d->op];
+#else
+    for (;;) {
+        C8_BUSCAR();
+    despachar:
+        switch (d->op) {
+            #define C8_CASO_OP(NOME, TIPO) case OP_##NOME: { C8_EXECUTAR(NOME, TIPO) } break;
+            C8_OPS(C8_CASO_OP)
+            #undef C8_CASO_OP
+            default: // OP_NAO_DECODIFICADA
+                C8_DECODIFICAR();
+                goto despachar;
+        }
+    }
+#endif
+}
+
+#if defined(__GNUC__)
+#pragma GCC diagnostic pop
+#endif
@@ -0,0 +1,39 @@
+#ifndef C8CACHE_H
+#define C8CACHE_H
+
+#include <stdint.h>
+#include "c8motor.h"
+#include "c8decod.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Motor de execução com cache de decodificação: cada endereço da RAM (par
+// ou ímpar) guarda a instrução já decodificada, e o despacho é feito por
+// uma tabela de rótulos (computed goto) em vez do switch aninhado.
+//
+// O cache é invalidado automaticamente quando FX33/FX55 escrevem na RAM
+// e quando o motor passa a executar outra VM. Se a RAM for alterada por
+// fora (ex: VM_CarregarROM na mesma VM), chame InvalidarTudo().
+class MotorCache : public Motor {
+public:
+    MotorCache();
+
+    // Mesmo contrato de VM::VM_ExecutarCiclos (resultado idêntico)
+    VM_Status Executar(VM& vm, uint64_t ciclos);
+
+    void Invalidar(uint32_t inicio, uint32_t tam);
+    void InvalidarTudo();
+
+    // Decodifica todas as instruções alcançáveis da análise
+    void Preaquecer(const VM& vm, const AnaliseROM& analise);
+
+private:
+    // Laço especializado para um perfil de quirks (veja C8_Quirks)
+    template<class Q> VM_Status ExecutarCom(VM& vm, uint64_t ciclos);
+
+    OpDecodificada cache[VM_TAM_RAM];
+    uint32_t tam_usado;         // Entradas a partir daqui estão vazias
+    const VM* vm_atual;
+};
+
+#endif
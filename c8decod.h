@@ -0,0 +1,174 @@
+#ifndef C8DECOD_H
+#define C8DECOD_H
+
+#include <stdint.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Tipos de operação, usados pelos motores de execução:
+//   C8_SEQ    - segue para a próxima instrução
+//   C8_DESVIO - pode alterar o PC (saltos, chamadas, skips, espera de tecla)
+//   C8_ESCRITA - escreve na RAM (pode modificar o próprio código)
+#define C8_SEQ     0
+#define C8_DESVIO  1
+#define C8_ESCRITA 2
+
+// Lista de todas as operações: X(NOME, TIPO). Cada NOME tem uma função
+// op_NOME em c8ops.h com a semântica da instrução. Além do CHIP-8, inclui
+// as extensões do SUPER-CHIP (00CN, 00FB-00FF, FX30, FX75, FX85) e do
+// XO-CHIP (00DN, 5XY2, 5XY3, F000 NNNN, FN01, F002, FX3A).
+#define C8_OPS(X)          \
+    X(0NNN, C8_SEQ)        \
+    X(00E0, C8_SEQ)        \
+    X(00EE, C8_DESVIO)     \
+    X(00CN, C8_SEQ)        \
+    X(00DN, C8_SEQ)        \
+    X(00FB, C8_SEQ)        \
+    X(00FC, C8_SEQ)        \
+    X(00FD, C8_DESVIO)     \
+    X(00FE, C8_SEQ)        \
+    X(00FF, C8_SEQ)        \
+    X(1NNN, C8_DESVIO)     \
+    X(2NNN, C8_DESVIO)     \
+    X(3XNN, C8_DESVIO)     \
+    X(4XNN, C8_DESVIO)     \
+    X(5XY0, C8_DESVIO)     \
+    X(5XY2, C8_ESCRITA)    \
+    X(5XY3, C8_SEQ)        \
+    X(6XNN, C8_SEQ)        \
+    X(7XNN, C8_SEQ)        \
+    X(8XY0, C8_SEQ)        \
+    X(8XY1, C8_SEQ)        \
+    X(8XY2, C8_SEQ)        \
+    X(8XY3, C8_SEQ)        \
+    X(8XY4, C8_SEQ)        \
+    X(8XY5, C8_SEQ)        \
+    X(8XY6, C8_SEQ)        \
+    X(8XY7, C8_SEQ)        \
+    X(8XYE, C8_SEQ)        \
+    X(9XY0, C8_DESVIO)     \
+    X(ANNN, C8_SEQ)        \
+    X(BNNN, C8_DESVIO)     \
+    X(CXNN, C8_SEQ)        \
+    X(DXYN, C8_SEQ)        \
+    X(EX9E, C8_DESVIO)     \
+    X(EXA1, C8_DESVIO)     \
+    X(F000, C8_DESVIO)     \
+    X(FN01, C8_SEQ)        \
+    X(F002, C8_SEQ)        \
+    X(FX07, C8_SEQ)        \
+    X(FX0A, C8_DESVIO)     \
+    X(FX15, C8_SEQ)        \
+    X(FX18, C8_SEQ)        \
+    X(FX1E, C8_SEQ)        \
+    X(FX29, C8_SEQ)        \
+    X(FX30, C8_SEQ)        \
+    X(FX33, C8_ESCRITA)    \
+    X(FX3A, C8_SEQ)        \
+    X(FX55, C8_ESCRITA)    \
+    X(FX65, C8_SEQ)        \
+    X(FX75, C8_SEQ)        \
+    X(FX85, C8_SEQ)        \
+    X(INVALIDA, C8_DESVIO)
+
+#define C8_ENUM_OP(NOME, TIPO) OP_##NOME,
+enum C8Op {
+    C8_OPS(C8_ENUM_OP)
+    OP_NAO_DECODIFICADA,  // Entrada vazia do cache de decodificação
+    C8_NUM_OPS
+};
+#undef C8_ENUM_OP
+
+// Instrução já decodificada: operação + operandos extraídos
+struct OpDecodificada {
+    uint8_t op;   // C8Op
+    uint8_t X;    // 2º nibble
+    uint8_t Y;    // 3º nibble
+    uint8_t N;    // 4 bits mais baixos
+    uint8_t NN;   // 8 bits mais baixos
+    uint16_t NNN; // 12 bits mais baixos
+};
+
+inline OpDecodificada C8_Decodificar(uint16_t inst) {
+    OpDecodificada d;
+    d.X = (inst & 0x0F00) >> 8;
+    d.Y = (inst & 0x00F0) >> 4;
+    d.N = inst & 0x000F;
+    d.NN = inst & 0x00FF;
+    d.NNN = inst & 0x0FFF;
+
+    switch (inst >> 12) {
+        case 0:
+            if (inst == 0x00E0)                 d.op = OP_00E0;
+            else if (inst == 0x00EE)            d.op = OP_00EE;
+            else if ((inst & 0xFFF0) == 0x00C0) d.op = OP_00CN;
+            else if ((inst & 0xFFF0) == 0x00D0) d.op = OP_00DN;
+            else if (inst == 0x00FB)            d.op = OP_00FB;
+            else if (inst == 0x00FC)            d.op = OP_00FC;
+            else if (inst == 0x00FD)            d.op = OP_00FD;
+            else if (inst == 0x00FE)            d.op = OP_00FE;
+            else if (inst == 0x00FF)            d.op = OP_00FF;
+            else                                d.op = OP_0NNN;
+            break;
+        case 1:   d.op = OP_1NNN; break;
+        case 2:   d.op = OP_2NNN; break;
+        case 3:   d.op = OP_3XNN; break;
+        case 4:   d.op = OP_4XNN; break;
+        case 5:
+            // Como antes das extensões, 5XY1 e afins continuam sendo 5XY0
+            if (d.N == 0x2)      d.op = OP_5XY2;
+            else if (d.N == 0x3) d.op = OP_5XY3;
+            else                 d.op = OP_5XY0;
+            break;
+        case 6:   d.op = OP_6XNN; break;
+        case 7:   d.op = OP_7XNN; break;
+        case 8:
+            switch (d.N) {
+                case 0x0: d.op = OP_8XY0; break;
+                case 0x1: d.op = OP_8XY1; break;
+                case 0x2: d.op = OP_8XY2; break;
+                case 0x3: d.op = OP_8XY3; break;
+                case 0x4: d.op = OP_8XY4; break;
+                case 0x5: d.op = OP_8XY5; break;
+                case 0x6: d.op = OP_8XY6; break;
+                case 0x7: d.op = OP_8XY7; break;
+                case 0xE: d.op = OP_8XYE; break;
+                default:  d.op = OP_INVALIDA; break;
+            }
+            break;
+        case 9:   d.op = OP_9XY0; break;
+        case 0xA: d.op = OP_ANNN; break;
+        case 0xB: d.op = OP_BNNN; break;
+        case 0xC: d.op = OP_CXNN; break;
+        case 0xD: d.op = OP_DXYN; break;
+        case 0xE:
+            if (d.NN == 0x9E)      d.op = OP_EX9E;
+            else if (d.NN == 0xA1) d.op = OP_EXA1;
+            else                   d.op = OP_INVALIDA;
+            break;
+        default: // 0xF
+            switch (d.NN) {
+                case 0x00: d.op = inst == 0xF000 ? OP_F000 : OP_INVALIDA; break;
+                case 0x01: d.op = OP_FN01; break;
+                case 0x02: d.op = inst == 0xF002 ? OP_F002 : OP_INVALIDA; break;
+                case 0x07: d.op = OP_FX07; break;
+                case 0x0A: d.op = OP_FX0A; break;
+                case 0x15: d.op = OP_FX15; break;
+                case 0x18: d.op = OP_FX18; break;
+                case 0x1E: d.op = OP_FX1E; break;
+                case 0x29: d.op = OP_FX29; break;
+                case 0x30: d.op = OP_FX30; break;
+                case 0x33: d.op = OP_FX33; break;
+                case 0x3A: d.op = OP_FX3A; break;
+                case 0x55: d.op = OP_FX55; break;
+                case 0x65: d.op = OP_FX65; break;
+                case 0x75: d.op = OP_FX75; break;
+                case 0x85: d.op = OP_FX85; break;
+                default:   d.op = OP_INVALIDA; break;
+            }
+            break;
+    }
+    return d;
+}
+
+#endif
@@ -0,0 +1,313 @@
+#include "c8estado.h"
+#include <stdio.h>
+#include <string.h>
+#include <vector>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+static const uint8_t ESTADO_MAGICO[4] = {'C', '8', 'E', 'S'};
+
+// Escrita/leitura little-endian independente do host
+static uint8_t* por16(uint8_t* p, uint16_t v) {
+    p[0] = v & 0xFF;
+    p[1] = v >> 8;
+    return p + 2;
+}
+
+static uint8_t* por32(uint8_t* p, uint32_t v) {
+    for (int i = 0; i < 4; i++) p[i] = (v >> (8 * i)) & 0xFF;
+    return p + 4;
+}
+
+static uint8_t* por64(uint8_t* p, uint64_t v) {
+    for (int i = 0; i < 8; i++) p[i] = (v >> (8 * i)) & 0xFF;
+    return p + 8;
+}
+
+static uint16_t ler16(const uint8_t** p) {
+    uint16_t v = (*p)[0] | ((*p)[1] << 8);
+    *p += 2;
+    return v;
+}
+
+static uint32_t ler32(const uint8_t** p) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= (uint32_t)(*p)[i] << (8 * i);
+    *p += 4;
+    return v;
+}
+
+static uint64_t ler64(const uint8_t** p) {
+    uint64_t v = 0;
+    for (int i = 0; i < 8; i++) v |= (uint64_t)(*p)[i] << (8 * i);
+    *p += 8;
+    return v;
+}
+
+// Quantos planos estão marcados em 'planos_tela'
+static int contar_planos(uint8_t planos_tela) {
+    int n = 0;
+    for (int pl = 0; pl < VM_PLANOS; pl++) n += (planos_tela >> pl) & 1;
+    return n;
+}
+
+size_t Estado_Tamanho(const VM& vm) {
+    return ESTADO_TAM_CABECALHO + contar_planos(vm.VM_PlanosTela()) * vm.VM_PalavrasTela() * 8 + vm.tam_ram;
+}
+
+// Página 'p' marcada em VM::paginas_alteradas
+static inline bool pagina_alterada(const VM& vm, int p) {
+    return (vm.paginas_alteradas[p / 64] >> (p % 64)) & 1;
+}
+
+void Estado_Salvar(const VM& vm, uint8_t* buf) {
+    uint8_t planos_tela = vm.VM_PlanosTela();
+    int palavras = vm.VM_PalavrasTela();
+    uint8_t* p = buf;
+    memcpy(p, ESTADO_MAGICO, 4); p += 4;
+    p = por16(p, ESTADO_VERSAO);
+    p = por16(p, 0);
+    p = por16(p, vm.PC);
+    p = por16(p, vm.I);
+    *p++ = vm.SP;
+    memcpy(p, vm.V, 16); p += 16;
+    for (int i = 0; i < 16; i++) p = por16(p, vm.stack[i]);
+    *p++ = vm.delay_timer;
+    *p++ = vm.sound_timer;
+    p = por32(p, vm.rng);
+    memcpy(p, vm.KEY, CHIP8_KEYS); p += CHIP8_KEYS;
+    *p++ = vm.hires;
+    *p++ = vm.planos;
+    *p++ = vm.tom_som;
+    *p++ = planos_tela;
+    memcpy(p, vm.padrao_som, 16); p += 16;
+    memcpy(p, vm.RPL, 16); p += 16;
+    p = por32(p, vm.tam_ram);
+    for (int pl = 0; pl < VM_PLANOS; pl++) {
+        if (!(planos_tela & (1 << pl))) continue;
+        for (int y = 0; y < palavras; y++) p = por64(p, vm.DISPLAY[pl][y]);
+    }
+    memcpy(p, vm.RAM, vm.tam_ram);
+}
+
+bool Estado_Carregar(VM& vm, const uint8_t* buf, size_t tam, std::string* erro) {
+    if (tam < 8 || memcmp(buf, ESTADO_MAGICO, 4) != 0) {
+        if (erro) *erro = "não é um estado salvo";
+        return false;
+    }
+    const uint8_t* p = buf + 4;
+    uint16_t versao = ler16(&p);
+    if (versao < 1 || versao > ESTADO_VERSAO) {
+        if (erro) *erro = "versão de estado não suportada";
+        return false;
+    }
+    p += 2; // Reservado
+
+    // Posição dos campos depois do KEY (a partir da versão 3)
+    const uint8_t* extra = p + 2 + 2 + 1 + 16 + 16 * 2 + 1 + 1 + 4 + CHIP8_KEYS;
+    uint32_t tam_ram = VM_TAM_RAM_CHIP8;
+    uint8_t planos_tela = (1 << VM_PLANOS) - 1; // A versão 3 tem a tela inteira
+    int palavras = VM_PALAVRAS_TELA;
+    size_t tam_esperado = versao == 1 ? ESTADO_TAM_SERIALIZADO_V1 : ESTADO_TAM_SERIALIZADO_V2;
+    if (versao >= 3) {
+        if (tam < ESTADO_TAM_CABECALHO) {
+            if (erro) *erro = "estado com tamanho inválido";
+            return false;
+        }
+        const uint8_t* q = extra + 4 + 16 + 16;
+        tam_ram = ler32(&q);
+        if (tam_ram != VM_TAM_RAM_CHIP8 && tam_ram != VM_TAM_RAM) {
+            if (erro) *erro = "tamanho de memória inválido";
+            return false;
+        }
+        if (extra[0] > 1 || extra[1] > 3) {
+            if (erro) *erro = "modo de tela inválido";
+            return false;
+        }
+        if (versao >= 4) {
+            planos_tela = extra[3];
+            palavras = extra[0] ? VM_PALAVRAS_TELA : VM_PALAVRAS_TELA / 4;
+            if (!(planos_tela & 1) || planos_tela >= 1 << VM_PLANOS) {
+                if (erro) *erro = "planos da tela inválidos";
+                return false;
+            }
+        }
+        tam_esperado = ESTADO_TAM_CABECALHO + contar_planos(planos_tela) * palavras * 8 + tam_ram;
+    }
+    if (tam_ram > VM_TamRAMQuirks((VM_Quirks)vm.quirks)) {
+        if (erro) *erro = "estado com 64KB de RAM: só carrega no perfil moderno (XO-CHIP)";
+        return false;
+    }
+    if (tam != tam_esperado) {
+        if (erro) *erro = "estado com tamanho inválido";
+        return false;
+    }
+
+    uint16_t pc = ler16(&p);
+    uint16_t i = ler16(&p);
+    uint8_t sp = *p++;
+    if (sp > 16) {
+        if (erro) *erro = "stack pointer inválido";
+        return false;
+    }
+    uint32_t rng = vm.rng;
+    if (versao >= 2) {
+        const uint8_t* q = p + 16 + 16 * 2 + 1 + 1;
+        rng = ler32(&q);
+        if (rng == 0) {
+            if (erro) *erro = "estado do gerador inválido";
+            return false;
+        }
+    }
+
+    vm.PC = pc;
+    vm.I = i;
+    vm.SP = sp;
+    memcpy(vm.V, p, 16); p += 16;
+    for (int k = 0; k < 16; k++) vm.stack[k] = ler16(&p);
+    vm.delay_timer = *p++;
+    vm.sound_timer = *p++;
+    if (versao >= 2) p += 4;
+    vm.rng = rng;
+    for (int k = 0; k < CHIP8_KEYS; k++) vm.KEY[k] = *p++ ? 1 : 0;
+
+    memset(vm.DISPLAY, 0, sizeof(vm.DISPLAY));
+    if (versao >= 3) {
+        vm.hires = *p++;
+        vm.planos = *p++;
+        vm.tom_som = *p++;
+        p++; // planos_tela, já lido
+        memcpy(vm.padrao_som, p, 16); p += 16;
+        memcpy(vm.RPL, p, 16); p += 16;
+        p += 4; // tam_ram, já lido
+        for (int pl = 0; pl < VM_PLANOS; pl++) {
+            if (!(planos_tela & (1 << pl))) continue;
+            for (int y = 0; y < palavras; y++) vm.DISPLAY[pl][y] = ler64(&p);
+        }
+    } else {
+        // Estados antigos: tela de 64x32 em um plano, sem os extras
+        vm.hires = 0;
+        vm.planos = 1;
+        vm.tom_som = 64;
+        memset(vm.padrao_som, 0, sizeof(vm.padrao_som));
+        memset(vm.RPL, 0, sizeof(vm.RPL));
+        for (int y = 0; y < 32; y++) vm.DISPLAY[0][y] = ler64(&p);
+    }
+    vm.VM_TrocarTamRAM(tam_ram);
+    memcpy(vm.RAM, p, tam_ram);
+    vm.VM_CrescerRAM(VM_TamRAMQuirks((VM_Quirks)vm.quirks)); // Estado de 4KB no XO-CHIP
+
+    vm.linhas_alteradas = ~0ULL;
+    memset(vm.paginas_alteradas, 0xFF, sizeof(vm.paginas_alteradas));
+    return true;
+}
+
+bool Estado_SalvarArquivo(const VM& vm, const char* caminho, std::string* erro) {
+    std::vector<uint8_t> buf(Estado_Tamanho(vm));
+    Estado_Salvar(vm, buf.data());
+
+    FILE* arq = fopen(caminho, "wb");
+    if (!arq) {
+        if (erro) *erro = "não foi possível criar o arquivo";
+        return false;
+    }
+    bool ok = fwrite(buf.data(), 1, buf.size(), arq) == buf.size();
+    if (fclose(arq) != 0) ok = false;
+    if (!ok && erro) *erro = "erro ao gravar o arquivo";
+    return ok;
+}
+
+bool Estado_CarregarArquivo(VM& vm, const char* caminho, std::string* erro) {
+    FILE* arq = fopen(caminho, "rb");
+    if (!arq) {
+        if (erro) *erro = "não foi possível abrir o arquivo";
+        return false;
+    }
+    // Lê um byte a mais para detectar arquivos maiores que o esperado
+    std::vector<uint8_t> buf(ESTADO_TAM_MAXIMO + 1);
+    size_t lido = fread(buf.data(), 1, buf.size(), arq);
+    fclose(arq);
+    return Estado_Carregar(vm, buf.data(), lido, erro);
+}
+
+void Estado_Capturar(VM& vm, EstadoVM& estado, const EstadoVM* base) {
+    estado.PC = vm.PC;
+    estado.I = vm.I;
+    estado.SP = vm.SP;
+    memcpy(estado.V, vm.V, sizeof(estado.V));
+    memcpy(estado.stack, vm.stack, sizeof(estado.stack));
+    estado.delay_timer = vm.delay_timer;
+    estado.sound_timer = vm.sound_timer;
+    estado.rng = vm.rng;
+    memcpy(estado.KEY, vm.KEY, sizeof(estado.KEY));
+    estado.hires = vm.hires;
+    estado.planos = vm.planos;
+    estado.planos_tela = vm.VM_PlanosTela();
+    for (int pl = 0; pl < VM_PLANOS; pl++) {
+        if (estado.planos_tela & (1 << pl)) memcpy(estado.DISPLAY[pl], vm.DISPLAY[pl], vm.VM_PalavrasTela() * 8);
+    }
+    estado.tom_som = vm.tom_som;
+    memcpy(estado.padrao_som, vm.padrao_som, sizeof(estado.padrao_som));
+    memcpy(estado.RPL, vm.RPL, sizeof(estado.RPL));
+    estado.tam_ram = vm.tam_ram;
+
+    // Uma base com outro tamanho de RAM não tem as páginas desta
+    if (base != NULL && base->tam_ram != vm.tam_ram) base = NULL;
+    int usadas = vm.tam_ram / VM_TAM_PAGINA;
+    estado.paginas.resize(usadas);
+    for (int p = 0; p < usadas; p++) {
+        if (base != NULL && base->paginas[p] && !pagina_alterada(vm, p)) {
+            // Página igual à da base: só mais uma referência
+            estado.paginas[p] = base->paginas[p];
+        } else {
+            std::shared_ptr<PaginaRAM> nova = std::make_shared<PaginaRAM>();
+            memcpy(nova->dados, &vm.RAM[p * VM_TAM_PAGINA], VM_TAM_PAGINA);
+            estado.paginas[p] = nova;
+        }
+    }
+    memset(vm.paginas_alteradas, 0, sizeof(vm.paginas_alteradas));
+}
+
+bool Estado_Restaurar(VM& vm, const EstadoVM& estado, const EstadoVM* atual, std::string* erro) {
+    if (estado.tam_ram > VM_TamRAMQuirks((VM_Quirks)vm.quirks)) {
+        if (erro) *erro = "estado com 64KB de RAM: só restaura no perfil moderno (XO-CHIP)";
+        return false;
+    }
+
+    vm.PC = estado.PC;
+    vm.I = estado.I;
+    vm.SP = estado.SP;
+    memcpy(vm.V, estado.V, sizeof(vm.V));
+    memcpy(vm.stack, estado.stack, sizeof(vm.stack));
+    vm.delay_timer = estado.delay_timer;
+    vm.sound_timer = estado.sound_timer;
+    vm.rng = estado.rng;
+    memcpy(vm.KEY, estado.KEY, sizeof(vm.KEY));
+    vm.hires = estado.hires;
+    vm.planos = estado.planos;
+    memset(vm.DISPLAY, 0, sizeof(vm.DISPLAY));
+    for (int pl = 0; pl < VM_PLANOS; pl++) {
+        if (estado.planos_tela & (1 << pl)) memcpy(vm.DISPLAY[pl], estado.DISPLAY[pl], vm.VM_PalavrasTela() * 8);
+    }
+    vm.tom_som = estado.tom_som;
+    memcpy(vm.padrao_som, estado.padrao_som, sizeof(vm.padrao_som));
+    memcpy(vm.RPL, estado.RPL, sizeof(vm.RPL));
+    vm.linhas_alteradas = ~0ULL;
+
+    // Com outro tamanho a VM passa a outro vetor de RAM, e 'atual' não tem
+    // as páginas do estado: copia tudo
+    if (vm.tam_ram != estado.tam_ram || (atual != NULL && atual->tam_ram != estado.tam_ram)) {
+        vm.VM_TrocarTamRAM(estado.tam_ram);
+        atual = NULL;
+    }
+
+    int usadas = estado.tam_ram / VM_TAM_PAGINA;
+    for (int p = 0; p < usadas; p++) {
+        // A VM ainda tem a página de 'atual' e ela é a mesma do estado
+        if (atual != NULL && !pagina_alterada(vm, p) && atual->paginas[p] == estado.paginas[p]) continue;
+        memcpy(&vm.RAM[p * VM_TAM_PAGINA], estado.paginas[p]->dados, VM_TAM_PAGINA);
+    }
+    vm.VM_CrescerRAM(VM_TamRAMQuirks((VM_Quirks)vm.quirks)); // Estado de 4KB no XO-CHIP
+    memset(vm.paginas_alteradas, 0, sizeof(vm.paginas_alteradas));
+    return true;
+}
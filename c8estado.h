@@ -0,0 +1,94 @@
+#ifndef C8ESTADO_H
+#define C8ESTADO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "c8vm.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Estados salvos da VM.
+//
+// 1) Formato binário versionado (arquivo ou buffer), little-endian:
+//      "C8ES" | versão u16 | reservado u16 | PC u16 | I u16 | SP u8 | V[16] |
+//      stack[16] u16 | delay u8 | sound u8 | rng u32 | KEY[16] | hires u8 |
+//      planos u8 | tom_som u8 | planos_tela u8 | padrao_som[16] | RPL[16] |
+//      tam_ram u32 | DISPLAY[n][palavras] u64 | RAM[tam_ram]
+//    Da tela só vai a parte em uso (VM::VM_PalavrasTela): 'palavras' é 32
+//    em lores e 128 em hires, e os n planos são os marcados em planos_tela.
+//    A versão 3 tinha um byte reservado no lugar de planos_tela e sempre
+//    DISPLAY[2][128]. As versões 1 e 2 (só CHIP-8) terminavam em
+//    DISPLAY[32] u64 | RAM[4096] logo depois do KEY; a versão 1 também não
+//    tinha o rng (ao carregá-la a VM mantém o gerador que tinha).
+//
+// 2) EstadoVM em memória, para bifurcar uma execução em muitas: a RAM fica
+//    em páginas de VM_TAM_PAGINA bytes compartilhadas (copy-on-write) entre
+//    os estados. Capturar um estado a partir do anterior só copia as páginas
+//    que a VM escreveu desde então (VM::paginas_alteradas); restaurar só
+//    copia as páginas que diferem do estado em que a VM estava.
+//
+// Depois de carregar/restaurar um estado em uma VM, chame
+// Motor::InvalidarTudo() no motor que a executa (a RAM mudou por fora).
+
+#define ESTADO_VERSAO 4
+#define ESTADO_TAM_SERIALIZADO_V1 (4 + 2 + 2 + 2 + 2 + 1 + 16 + 16 * 2 + 1 + 1 + CHIP8_KEYS + 32 * 8 + 4096)
+#define ESTADO_TAM_SERIALIZADO_V2 (ESTADO_TAM_SERIALIZADO_V1 + 4)
+// Tudo menos a tela e a RAM
+#define ESTADO_TAM_CABECALHO (4 + 2 + 2 + 2 + 2 + 1 + 16 + 16 * 2 + 1 + 1 + 4 + CHIP8_KEYS + \
+                              4 + 16 + 16 + 4)
+#define ESTADO_TAM_TELA_MAXIMO (VM_PLANOS * VM_PALAVRAS_TELA * 8)
+#define ESTADO_TAM_MAXIMO (ESTADO_TAM_CABECALHO + ESTADO_TAM_TELA_MAXIMO + VM_TAM_RAM)
+
+// Tamanho do estado serializado desta VM
+size_t Estado_Tamanho(const VM& vm);
+
+// Grava o estado da VM em 'buf' (Estado_Tamanho(vm) bytes)
+void Estado_Salvar(const VM& vm, uint8_t* buf);
+
+// Lê um estado gravado por Estado_Salvar. Em caso de erro a VM não é alterada.
+// O perfil de quirks da VM fica e decide o tamanho da RAM: um estado de 4KB
+// carregado no XO-CHIP ganha os 64KB com o resto zerado, e um de 64KB só
+// carrega no XO-CHIP.
+bool Estado_Carregar(VM& vm, const uint8_t* buf, size_t tam, std::string* erro);
+
+bool Estado_SalvarArquivo(const VM& vm, const char* caminho, std::string* erro);
+bool Estado_CarregarArquivo(VM& vm, const char* caminho, std::string* erro);
+
+struct PaginaRAM {
+    uint8_t dados[VM_TAM_PAGINA];
+};
+
+// Estado completo em memória (imutável depois de capturado)
+struct EstadoVM {
+    uint16_t PC;
+    uint16_t I;
+    uint8_t SP;
+    uint8_t V[16];
+    uint16_t stack[16];
+    uint8_t delay_timer;
+    uint8_t sound_timer;
+    uint32_t rng;
+    uint8_t KEY[CHIP8_KEYS];
+    uint64_t DISPLAY[VM_PLANOS][VM_PALAVRAS_TELA]; // Só a parte em uso (planos_tela)
+    uint8_t hires;
+    uint8_t planos;
+    uint8_t planos_tela;     // VM::VM_PlanosTela()
+    uint8_t tom_som;
+    uint8_t padrao_som[16];
+    uint8_t RPL[16];
+    uint32_t tam_ram;
+    std::vector<std::shared_ptr<const PaginaRAM> > paginas; // tam_ram / VM_TAM_PAGINA páginas
+};
+
+// 'base' (ou 'atual') deve ser o último estado capturado desta VM ou
+// restaurado nela, ou NULL para copiar a RAM inteira. As duas funções zeram
+// vm.paginas_alteradas: o estado resultante passa a ser a nova referência.
+// Estado_Restaurar segue o perfil da VM como Estado_Carregar e, se o
+// estado não couber nele, retorna false sem alterar a VM.
+void Estado_Capturar(VM& vm, EstadoVM& estado, const EstadoVM* base);
+bool Estado_Restaurar(VM& vm, const EstadoVM& estado, const EstadoVM* atual, std::string* erro);
+
+#endif
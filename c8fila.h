@@ -0,0 +1,92 @@
+#ifndef C8FILA_H
+#define C8FILA_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <atomic>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Estruturas sem trava para passar dados entre duas threads.
+
+// Fila circular sem trava para exatamente uma thread produtora e uma
+// consumidora (ex: emulação -> áudio). 'Capacidade' precisa ser potência de
+// 2; cabem Capacidade - 1 itens. Cada índice só é escrito por uma das
+// threads, então basta acquire/release nos dois contadores.
+template <typename T, size_t Capacidade>
+class FilaSPSC {
+public:
+    FilaSPSC() : inicio(0), fim(0) {}
+
+    // Thread produtora. Retorna false (e descarta o item) se estiver cheia.
+    bool Colocar(const T& item) {
+        size_t f = this->fim.load(std::memory_order_relaxed);
+        size_t prox = (f + 1) & (Capacidade - 1);
+        if (prox == this->inicio.load(std::memory_order_acquire)) return false;
+        this->itens[f] = item;
+        this->fim.store(prox, std::memory_order_release);
+        return true;
+    }
+
+    // Thread consumidora. Retorna false se estiver vazia.
+    bool Tirar(T* item) {
+        size_t i = this->inicio.load(std::memory_order_relaxed);
+        if (i == this->fim.load(std::memory_order_acquire)) return false;
+        *item = this->itens[i];
+        this->inicio.store((i + 1) & (Capacidade - 1), std::memory_order_release);
+        return true;
+    }
+
+    // Thread consumidora: olha o próximo item sem tirá-lo
+    bool Espiar(T* item) const {
+        size_t i = this->inicio.load(std::memory_order_relaxed);
+        if (i == this->fim.load(std::memory_order_acquire)) return false;
+        *item = this->itens[i];
+        return true;
+    }
+
+private:
+    static_assert((Capacidade & (Capacidade - 1)) == 0 && Capacidade >= 2, "Capacidade deve ser potência de 2");
+
+    // Em linhas de cache separadas: cada thread só escreve no seu contador
+    alignas(64) std::atomic<size_t> inicio;
+    alignas(64) std::atomic<size_t> fim;
+    T itens[Capacidade];
+};
+
+// Buffer triplo sem trava, de uma thread produtora para uma consumidora:
+// o produtor sempre tem um buffer livre para escrever (nunca espera o
+// consumidor) e o consumidor sempre lê o último buffer completo publicado.
+// Quadros publicados que o consumidor não chegou a pegar são descartados.
+template <typename T>
+class BufferTriplo {
+public:
+    BufferTriplo() : escrita(0), leitura(1), meio(2) {}
+
+    // Thread produtora: preenche Escrita() e chama Publicar()
+    T& Escrita() { return this->buf[this->escrita]; }
+
+    void Publicar() {
+        this->escrita = this->meio.exchange(this->escrita | NOVO, std::memory_order_acq_rel) & ~NOVO;
+    }
+
+    // Thread consumidora: pega o último buffer publicado, se houver um novo
+    // desde a última chamada. Leitura() continua válido até a próxima.
+    bool Atualizar() {
+        if (!(this->meio.load(std::memory_order_relaxed) & NOVO)) return false;
+        this->leitura = this->meio.exchange(this->leitura, std::memory_order_acq_rel) & ~NOVO;
+        return true;
+    }
+
+    const T& Leitura() const { return this->buf[this->leitura]; }
+
+private:
+    enum { NOVO = 4 }; // Bit em 'meio': o buffer do meio ainda não foi lido
+
+    T buf[3];
+    uint8_t escrita;             // Só a produtora mexe
+    uint8_t leitura;             // Só a consumidora mexe
+    std::atomic<uint8_t> meio;   // Índice trocado entre as duas (+ NOVO)
+};
+
+#endif
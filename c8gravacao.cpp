@@ -0,0 +1,131 @@
+#include "c8gravacao.h"
+#include <stdio.h>
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+static const uint8_t GRAVACAO_MAGICO[4] = {'C', '8', 'G', 'R'};
+
+#define GRAVACAO_TAM_CABECALHO (4 + 2 + 2 + 8 + 4 + 2 + 2 + 8 + 4 + 8 + 4)
+
+// Escrita/leitura little-endian independente do host
+static void por(std::vector<uint8_t>& buf, uint64_t v, int bytes) {
+    for (int i = 0; i < bytes; i++) buf.push_back((v >> (8 * i)) & 0xFF);
+}
+
+static uint64_t ler(const uint8_t** p, int bytes) {
+    uint64_t v = 0;
+    for (int i = 0; i < bytes; i++) v |= (uint64_t)(*p)[i] << (8 * i);
+    *p += bytes;
+    return v;
+}
+
+bool Gravacao_Salvar(const Gravacao& g, const char* caminho, std::string* erro) {
+    std::vector<uint8_t> buf;
+    buf.reserve(GRAVACAO_TAM_CABECALHO + g.eventos.size() * 2);
+    buf.insert(buf.end(), GRAVACAO_MAGICO, GRAVACAO_MAGICO + 4);
+    por(buf, GRAVACAO_VERSAO, 2);
+    por(buf, 0, 2);
+    por(buf, g.semente, 8);
+    por(buf, g.hz, 4);
+    por(buf, g.pc_inicial, 2);
+    por(buf, g.quirks, 2);
+    por(buf, g.hash_inicial, 8);
+    por(buf, g.quadros, 4);
+    por(buf, g.hash_final, 8);
+    por(buf, g.eventos.size(), 4);
+
+    uint32_t anterior = 0;
+    for (size_t i = 0; i < g.eventos.size(); i++) {
+        const EventoEntrada& ev = g.eventos[i];
+        if (ev.quadro < anterior || ev.tecla > 0xF) {
+            if (erro) *erro = "eventos fora de ordem ou tecla inválida";
+            return false;
+        }
+        uint32_t delta = ev.quadro - anterior;
+        anterior = ev.quadro;
+        while (delta >= 0x80) {
+            buf.push_back((delta & 0x7F) | 0x80);
+            delta >>= 7;
+        }
+        buf.push_back((uint8_t)delta);
+        buf.push_back(ev.tecla | (ev.pressionada ? 0x80 : 0));
+    }
+
+    FILE* arq = fopen(caminho, "wb");
+    if (!arq) {
+        if (erro) *erro = "não foi possível criar o arquivo";
+        return false;
+    }
+    bool ok = fwrite(buf.data(), 1, buf.size(), arq) == buf.size();
+    if (fclose(arq) != 0) ok = false;
+    if (!ok && erro) *erro = "erro ao gravar o arquivo";
+    return ok;
+}
+
+bool Gravacao_Carregar(Gravacao& g, const char* caminho, std::string* erro) {
+    FILE* arq = fopen(caminho, "rb");
+    if (!arq) {
+        if (erro) *erro = "não foi possível abrir o arquivo";
+        return false;
+    }
+    std::vector<uint8_t> buf;
+    uint8_t bloco[4096];
+    size_t lido;
+    while ((lido = fread(bloco, 1, sizeof(bloco), arq)) > 0) buf.insert(buf.end(), bloco, bloco + lido);
+    fclose(arq);
+
+    if (buf.size() < GRAVACAO_TAM_CABECALHO || memcmp(buf.data(), GRAVACAO_MAGICO, 4) != 0) {
+        if (erro) *erro = "não é uma gravação de entrada";
+        return false;
+    }
+    const uint8_t* p = buf.data() + 4;
+    const uint8_t* fim = buf.data() + buf.size();
+    if (ler(&p, 2) != GRAVACAO_VERSAO) {
+        if (erro) *erro = "versão de gravação não suportada";
+        return false;
+    }
+    p += 2; // Reservado
+    g.semente = ler(&p, 8);
+    g.hz = (uint32_t)ler(&p, 4);
+    g.pc_inicial = (uint16_t)ler(&p, 2);
+    g.quirks = (uint16_t)ler(&p, 2);
+    g.hash_inicial = ler(&p, 8);
+    g.quadros = (uint32_t)ler(&p, 4);
+    g.hash_final = ler(&p, 8);
+    uint32_t num_eventos = (uint32_t)ler(&p, 4);
+
+    g.eventos.clear();
+    uint32_t quadro = 0;
+    for (uint32_t i = 0; i < num_eventos; i++) {
+        uint32_t delta = 0;
+        int desloc = 0;
+        for (;;) {
+            if (p == fim || desloc > 28) {
+                if (erro) *erro = "gravação truncada ou corrompida";
+                return false;
+            }
+            uint8_t b = *p++;
+            delta |= (uint32_t)(b & 0x7F) << desloc;
+            desloc += 7;
+            if (!(b & 0x80)) break;
+        }
+        if (p == fim || (*p & 0x70) != 0) {
+            if (erro) *erro = "gravação truncada ou corrompida";
+            return false;
+        }
+        quadro += delta;
+
+        EventoEntrada ev;
+        ev.quadro = quadro;
+        ev.tecla = *p & 0x0F;
+        ev.pressionada = (*p & 0x80) ? 1 : 0;
+        p++;
+        g.eventos.push_back(ev);
+    }
+    if (p != fim) {
+        if (erro) *erro = "dados sobrando no fim da gravação";
+        return false;
+    }
+    return true;
+}
@@ -0,0 +1,50 @@
+#ifndef C8GRAVACAO_H
+#define C8GRAVACAO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Gravação da entrada de uma sessão, para reproduzi-la sem janela e bit a
+// bit igual (chip8_headless --reproduzir). Com a mesma ROM, semente, hz e
+// perfil de quirks, os eventos de teclado de cada quadro determinam toda a
+// execução.
+//
+// Formato binário, little-endian:
+//   "C8GR" | versão u16 | reservado u16 | semente u64 | hz u32 | pc u16 |
+//   quirks u16 | hash_inicial u64 | quadros u32 | hash_final u64 |
+//   num_eventos u32 | eventos
+// Cada evento ocupa normalmente 2 bytes: quadros desde o evento anterior
+// (varint, 7 bits por byte) e um byte com a tecla (bits 0-3) e o estado
+// (bit 7 = apertada).
+
+// Versão 2: o hash de estado passou a cobrir a fonte grande e o modo de
+// tela do SUPER-CHIP/XO-CHIP, então os hashes da versão 1 não conferem mais.
+// O campo quirks ocupou um reservado (zero = VM_QUIRKS_PADRAO).
+// Versão 3: o hash passou a cobrir o tamanho da RAM e só a parte ativa da
+// tela, e as instruções SUPER-CHIP/XO-CHIP dependem do perfil de quirks.
+#define GRAVACAO_VERSAO 3
+
+struct EventoEntrada {
+    uint32_t quadro;      // Quadro em que o evento é aplicado
+    uint8_t tecla;        // 0x0 a 0xF
+    uint8_t pressionada;  // 1 = apertou, 0 = soltou
+};
+
+struct Gravacao {
+    uint64_t semente;         // Passada para VM::VM_Semear
+    uint32_t hz;
+    uint16_t pc_inicial;
+    uint16_t quirks;          // VM_Quirks (c8vm.h)
+    uint64_t hash_inicial;    // VM_HashEstado com a ROM carregada e a semente aplicada
+    uint32_t quadros;         // Quadros gravados (incluindo o da falha, se houve)
+    uint64_t hash_final;      // VM_HashEstado no fim do último quadro
+    std::vector<EventoEntrada> eventos; // Em ordem de quadro
+};
+
+bool Gravacao_Salvar(const Gravacao& g, const char* caminho, std::string* erro);
+bool Gravacao_Carregar(Gravacao& g, const char* caminho, std::string* erro);
+
+#endif
@@ -0,0 +1,577 @@
+#include "c8grupo.h"
+#include "c8ops.h"
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Elemento da instância i em um vetor de faixas
+#define C8_FAIXA(v, i) (v)[(i) / GRUPO_LARGURA][(i) % GRUPO_LARGURA]
+
+// Faixas só são retornadas por funções estáticas deste arquivo: o aviso de
+// mudança de ABI sem -mavx não se aplica
+#pragma GCC diagnostic ignored "-Wpsabi"
+
+// Mantém 'velho' nas instâncias fora da máscara
+static inline Faixa8 mesclar8(const Faixa8& novo, const Faixa8& velho, const Faixa8& m) {
+    return (novo & m) | (velho & ~m);
+}
+
+static inline Faixa16 mesclar16(const Faixa16& novo, const Faixa16& velho, const Faixa16& m) {
+    return (novo & m) | (velho & ~m);
+}
+
+static inline bool algum(const Faixa8& v) {
+    uint64_t p[GRUPO_LARGURA / 8];
+    memcpy(p, &v, sizeof(p));
+    uint64_t r = 0;
+    for (size_t k = 0; k < GRUPO_LARGURA / 8; k++) r |= p[k];
+    return r != 0;
+}
+
+static inline void marcar_escrita(uint8_t* escrito, const VM& vm, const OpDecodificada& d) {
+    uint32_t ini, tam;
+    C8_FaixaEscrita(vm, d, &ini, &tam);
+    for (uint32_t a = ini; a < ini + tam && a < VM_TAM_RAM; a++) escrito[a] = 1;
+}
+
+// Instrução em 'pc' (já mascarado): do cache compartilhado se nenhuma
+// instância escreveu ali, senão decodificada da RAM da própria instância
+static inline OpDecodificada grupo_decodificar(const VM& vm, uint16_t pc,
+                                               const uint8_t* escrito, OpDecodificada* decod) {
+    uint32_t pc2 = C8_Endereco(vm, pc + 1);
+    if (escrito[pc] | escrito[pc2]) return C8_Decodificar((vm.RAM[pc] << 8) | vm.RAM[pc2]);
+    if (decod[pc].op == OP_NAO_DECODIFICADA) decod[pc] = C8_Decodificar((vm.RAM[pc] << 8) | vm.RAM[pc2]);
+    return decod[pc];
+}
+
+// Um ciclo de uma instância fora do lock-step: igual a VM::VM_Passo, mas
+// anotando os endereços escritos por FX33/FX55 (sem o rastro de DEBUG)
+template<class Q>
+static inline VM_Status grupo_passo(VM& vm, uint8_t* escrito, OpDecodificada* decod) {
+    vm.PC &= vm.tam_ram - 1;
+    OpDecodificada d = grupo_decodificar(vm, vm.PC, escrito, decod);
+    vm.PC += 2;
+
+    #define C8_CASO_OP(NOME, TIPO)                                  \
+        case OP_##NOME:                                             \
+            if (TIPO == C8_ESCRITA) marcar_escrita(escrito, vm, d); \
+            return op_##NOME<Q>(vm, d);
+    switch (d.op) {
+        C8_OPS(C8_CASO_OP)
+        default: break;
+    }
+    #undef C8_CASO_OP
+    return VM_ERRO_OPCODE_INVALIDO;
+}
+
+// Destino de um skip tomado em 'pc' (o F000 NNNN do XO-CHIP é pulado
+// inteiro, como em C8_Pular)
+template<class Q>
+static inline uint16_t grupo_destino_skip(const VM& vm, uint16_t pc) {
+    uint32_t prox = pc + 2;
+    bool longa = Q::extensao >= VM_EXT_XOCHIP &&
+                 vm.RAM[C8_Endereco(vm, prox)] == 0xF0 && vm.RAM[C8_Endereco(vm, prox + 1)] == 0x00;
+    return pc + (longa ? 6 : 4);
+}
+
+GrupoVM::GrupoVM(int instancias) : vms(instancias), status(instancias, VM_OK) {
+    this->n = instancias;
+    this->nb = (instancias + GRUPO_LARGURA - 1) / GRUPO_LARGURA;
+
+    for (int x = 0; x < 16; x++) {
+        this->V[x].assign(this->nb, Faixa8{});
+        this->stack[x].assign(this->nb, Faixa16{});
+    }
+    this->SP.assign(this->nb, Faixa8{});
+    this->delay_timer.assign(this->nb, Faixa8{});
+    this->sound_timer.assign(this->nb, Faixa8{});
+    this->I.assign(this->nb, Faixa16{});
+    this->PC.assign(this->nb, Faixa16{});
+    this->ativa8.assign(this->nb, Faixa8{});
+    this->ativa16.assign(this->nb, Faixa16{});
+    this->cond.assign(this->nb, Faixa8{});
+
+    this->Inicializar(0x200);
+}
+
+void GrupoVM::Inicializar(uint16_t pc_inicial) {
+    for (int i = 0; i < this->n; i++) {
+        this->vms[i].VM_Inicializar(pc_inicial);
+        this->status[i] = VM_OK;
+        C8_FAIXA(this->ativa8, i) = 0xFF;
+        C8_FAIXA(this->ativa16, i) = 0xFFFF;
+    }
+    this->ativas = this->n;
+    this->ref = 0;
+    this->em_vms = true;
+    this->pc_comum = pc_inicial;
+    memset(this->escrito, 0, sizeof(this->escrito));
+    for (int a = 0; a < VM_TAM_RAM; a++) this->decod[a].op = OP_NAO_DECODIFICADA;
+    this->ciclos_vetoriais = 0;
+    this->ciclos_escalares = 0;
+}
+
+bool GrupoVM::CarregarROM(const char* arq_rom, uint16_t pc_inicial, std::string* erro) {
+    // O arquivo é lido uma vez (cache de c8rom.h) e copiado para cada instância
+    for (int i = 0; i < this->n; i++) {
+        if (!this->vms[i].VM_CarregarROM(arq_rom, pc_inicial, erro)) return false;
+    }
+    for (int a = 0; a < VM_TAM_RAM; a++) this->decod[a].op = OP_NAO_DECODIFICADA;
+    return true;
+}
+
+bool GrupoVM::DefinirQuirks(VM_Quirks quirks, std::string* erro) {
+    // As instâncias têm a mesma RAM: se uma falha, é a primeira
+    for (int i = 0; i < this->n; i++) {
+        if (!this->vms[i].VM_DefinirQuirks(quirks, erro)) return false;
+    }
+    return true;
+}
+
+void GrupoVM::Desativar(int i, VM_Status st, uint16_t pc) {
+    this->status[i] = st;
+    C8_FAIXA(this->PC, i) = pc;
+    C8_FAIXA(this->ativa8, i) = 0;
+    C8_FAIXA(this->ativa16, i) = 0;
+    this->ativas--;
+
+    if (i == this->ref) {
+        while (this->ref < this->n && C8_FAIXA(this->ativa8, this->ref) == 0) this->ref++;
+    }
+}
+
+// Registradores dos vetores -> VMs. Com usar_pc_comum as instâncias ativas
+// recebem pc_comum; senão cada uma recebe o seu PC[i].
+void GrupoVM::Espalhar(bool usar_pc_comum) {
+    for (int i = 0; i < this->n; i++) {
+        VM& vm = this->vms[i];
+        for (int x = 0; x < 16; x++) {
+            vm.V[x] = C8_FAIXA(this->V[x], i);
+            vm.stack[x] = C8_FAIXA(this->stack[x], i);
+        }
+        vm.I = C8_FAIXA(this->I, i);
+        vm.SP = C8_FAIXA(this->SP, i);
+        vm.delay_timer = C8_FAIXA(this->delay_timer, i);
+        vm.sound_timer = C8_FAIXA(this->sound_timer, i);
+        vm.PC = (usar_pc_comum && C8_FAIXA(this->ativa8, i)) ? this->pc_comum : C8_FAIXA(this->PC, i);
+    }
+    this->em_vms = true;
+}
+
+// VMs -> vetores (o PC das ativas é pc_comum)
+void GrupoVM::Reunir() {
+    for (int i = 0; i < this->n; i++) {
+        const VM& vm = this->vms[i];
+        for (int x = 0; x < 16; x++) {
+            C8_FAIXA(this->V[x], i) = vm.V[x];
+            C8_FAIXA(this->stack[x], i) = vm.stack[x];
+        }
+        C8_FAIXA(this->I, i) = vm.I;
+        C8_FAIXA(this->SP, i) = vm.SP;
+        C8_FAIXA(this->delay_timer, i) = vm.delay_timer;
+        C8_FAIXA(this->sound_timer, i) = vm.sound_timer;
+        C8_FAIXA(this->PC, i) = vm.PC;
+    }
+    this->em_vms = false;
+}
+
+// Todas as instâncias ativas (nos VMs) estão no mesmo PC?
+bool GrupoVM::Convergiu() {
+    if (this->ativas == 0) return false;
+    uint16_t pc = this->vms[this->ref].PC;
+    for (int i = this->ref + 1; i < this->n; i++) {
+        if (C8_FAIXA(this->ativa8, i) && this->vms[i].PC != pc) return false;
+    }
+    this->pc_comum = pc;
+    return true;
+}
+
+VM& GrupoVM::Instancia(int instancia) {
+    if (!this->em_vms) this->Espalhar(true);
+    return this->vms[instancia];
+}
+
+void GrupoVM::ProcessarTimers() {
+    if (this->em_vms) {
+        for (int i = 0; i < this->n; i++) {
+            if (C8_FAIXA(this->ativa8, i)) this->vms[i].VM_ProcessarTimers();
+        }
+        return;
+    }
+    // (t != 0) vale 0xFF por instância: somar 0xFF é decrementar
+    for (int b = 0; b < this->nb; b++) {
+        Faixa8 m = this->ativa8[b];
+        Faixa8 d = this->delay_timer[b];
+        Faixa8 s = this->sound_timer[b];
+        this->delay_timer[b] = d + ((Faixa8)(d != 0) & m);
+        this->sound_timer[b] = s + ((Faixa8)(s != 0) & m);
+    }
+}
+
+void GrupoVM::ProcessarInput(int instancia, uint8_t key_index, bool is_down) {
+    this->vms[instancia].VM_ProcessarInput(key_index, is_down);
+}
+
+int GrupoVM::Executar(uint64_t ciclos) {
+    C8_DESPACHAR_QUIRKS(this->vms[0].quirks, this->ExecutarCom<Q>(ciclos));
+}
+
+template<class Q>
+int GrupoVM::ExecutarCom(uint64_t ciclos) {
+    uint64_t feitos = 0;
+    bool tentar_convergir = true;
+
+    while (feitos < ciclos && this->ativas > 0) {
+        if (this->em_vms && tentar_convergir && this->Convergiu()) this->Reunir();
+
+        if (!this->em_vms) {
+            feitos += this->ExecutarVetorial<Q>(ciclos - feitos);
+            // Saiu do lock-step: anda pelo menos uma janela antes de tentar
+            // de novo (o código em pc_comum pode diferir entre as instâncias)
+            tentar_convergir = false;
+            continue;
+        }
+
+        uint64_t janela = ciclos - feitos;
+        if (janela > GRUPO_JANELA_ESCALAR) janela = GRUPO_JANELA_ESCALAR;
+
+        for (int i = this->ref; i < this->n; i++) {
+            if (!C8_FAIXA(this->ativa8, i)) continue;
+            VM& vm = this->vms[i];
+            uint64_t k;
+            for (k = 0; k < janela; k++) {
+                VM_Status st = grupo_passo<Q>(vm, this->escrito, this->decod);
+                if (st != VM_OK) {
+                    this->Desativar(i, st, vm.PC);
+                    break;
+                }
+            }
+            this->ciclos_escalares += k;
+        }
+        feitos += janela;
+        tentar_convergir = true;
+    }
+    return this->ativas;
+}
+
+// Resolve um skip/espera: cond[i] escolhe entre pc_sim e pc_nao. Se as
+// instâncias discordarem, sai do lock-step.
+void GrupoVM::Desviar(uint16_t pc_sim, uint16_t pc_nao) {
+    Faixa8 sim = {}, nao = {};
+    for (int b = 0; b < this->nb; b++) {
+        sim |= this->cond[b] & this->ativa8[b];
+        nao |= ~this->cond[b] & this->ativa8[b];
+    }
+    if (!algum(sim) || !algum(nao)) {
+        this->pc_comum = algum(sim) ? pc_sim : pc_nao;
+        return;
+    }
+
+    for (int i = 0; i < this->n; i++) {
+        if (C8_FAIXA(this->ativa8, i)) C8_FAIXA(this->PC, i) = C8_FAIXA(this->cond, i) ? pc_sim : pc_nao;
+    }
+    this->Espalhar(false);
+}
+
+// O destino de cada instância ativa já está em PC[i]
+void GrupoVM::DesviarPorInstancia() {
+    if (this->ativas == 0) return;
+    uint16_t pc = C8_FAIXA(this->PC, this->ref);
+    for (int i = this->ref + 1; i < this->n; i++) {
+        if (C8_FAIXA(this->ativa8, i) && C8_FAIXA(this->PC, i) != pc) {
+            this->Espalhar(false);
+            return;
+        }
+    }
+    this->pc_comum = pc;
+}
+
+// Operações que mexem na RAM/tela/gerador/flags de cada instância: roda a
+// semântica de c8ops.h em cada VM, com os V e o I da instância
+template<class Q>
+void GrupoVM::ExecutarNasInstancias(const OpDecodificada& d) {
+    for (int i = this->ref; i < this->n; i++) {
+        if (!C8_FAIXA(this->ativa8, i)) continue;
+        VM& vm = this->vms[i];
+        for (int x = 0; x < 16; x++) vm.V[x] = C8_FAIXA(this->V[x], i);
+        vm.I = C8_FAIXA(this->I, i);
+
+        #define C8_CASO_OP(NOME, TIPO)                                        \
+            case OP_##NOME:                                                   \
+                if (TIPO == C8_ESCRITA) marcar_escrita(this->escrito, vm, d); \
+                op_##NOME<Q>(vm, d);                                          \
+                break;
+        switch (d.op) {
+            C8_OPS(C8_CASO_OP)
+            default: break;
+        }
+        #undef C8_CASO_OP
+
+        for (int x = 0; x < 16; x++) C8_FAIXA(this->V[x], i) = vm.V[x];
+        C8_FAIXA(this->I, i) = vm.I;
+    }
+}
+
+// Lock-step: busca e decodifica uma vez, executa em todas as instâncias
+// ativas. Retorna os ciclos executados; sai antes do fim se os PCs
+// divergirem (em_vms fica true) ou se todas falharem.
+template<class Q>
+uint64_t GrupoVM::ExecutarVetorial(uint64_t ciclos) {
+    uint64_t feitos = 0;
+
+    while (feitos < ciclos) {
+        // O PC dá a volta no fim da memória, como em VM::VM_Passo
+        const VM& vm_ref = this->vms[this->ref];
+        uint16_t pc = C8_Endereco(vm_ref, this->pc_comum);
+        uint32_t pc2 = C8_Endereco(vm_ref, pc + 1);
+
+        const uint8_t* ram = vm_ref.RAM;
+        if (this->escrito[pc] | this->escrito[pc2]) {
+            // Código já escrito por alguma instância: confere se é o mesmo em todas
+            uint16_t inst = (ram[pc] << 8) | ram[pc2];
+            for (int i = this->ref + 1; i < this->n; i++) {
+                if (!C8_FAIXA(this->ativa8, i)) continue;
+                const uint8_t* r = this->vms[i].RAM;
+                if (((r[pc] << 8) | r[pc2]) != inst) {
+                    this->Espalhar(true);
+                    return feitos;
+                }
+            }
+        }
+
+        OpDecodificada d = grupo_decodificar(vm_ref, pc, this->escrito, this->decod);
+        // Extensão que o perfil não tem: inválida (veja C8_EXIGIR_EXTENSAO)
+        if (C8_ExtensaoOp(d.op) > Q::extensao) d.op = OP_INVALIDA;
+
+        // Raras, ficam com a execução escalar: F000 NNNN (instrução de 4
+        // bytes), 00FD e skips sobre código que alguma instância alterou
+        // (o tamanho da instrução pulada pode variar entre as instâncias)
+        bool skip = d.op == OP_3XNN || d.op == OP_4XNN || d.op == OP_5XY0 || d.op == OP_9XY0 ||
+                    d.op == OP_EX9E || d.op == OP_EXA1;
+        if (d.op == OP_F000 || d.op == OP_00FD ||
+            (skip && (this->escrito[C8_Endereco(vm_ref, pc + 2)] | this->escrito[C8_Endereco(vm_ref, pc + 3)]))) {
+            this->Espalhar(true);
+            return feitos;
+        }
+        uint16_t pc_skip = grupo_destino_skip<Q>(vm_ref, pc);
+
+        this->pc_comum = pc + 2;
+        feitos++;
+        this->ciclos_vetoriais += this->ativas;
+
+        std::vector<Faixa8>& vx = this->V[d.X];
+        std::vector<Faixa8>& vy = this->V[d.Y];
+        std::vector<Faixa8>& vf = this->V[0xF];
+        std::vector<Faixa8>& vs = Q::desloca_vy ? vy : vx; // Fonte de 8XY6/8XYE
+
+        switch (d.op) {
+        case OP_0NNN:
+            break;
+        case OP_1NNN:
+            this->pc_comum = d.NNN;
+            break;
+        case OP_2NNN:
+            for (int i = this->ref; i < this->n; i++) {
+                if (!C8_FAIXA(this->ativa8, i)) continue;
+                uint8_t sp = C8_FAIXA(this->SP, i);
+                if (sp >= 16) {
+                    this->Desativar(i, VM_ERRO_PILHA_CHEIA, pc);
+                    continue;
+                }
+                C8_FAIXA(this->stack[sp], i) = pc + 2;
+                C8_FAIXA(this->SP, i) = sp + 1;
+            }
+            this->pc_comum = d.NNN;
+            break;
+        case OP_00EE:
+            for (int i = this->ref; i < this->n; i++) {
+                if (!C8_FAIXA(this->ativa8, i)) continue;
+                uint8_t sp = C8_FAIXA(this->SP, i);
+                if (sp == 0) {
+                    this->Desativar(i, VM_ERRO_PILHA_VAZIA, pc);
+                    continue;
+                }
+                C8_FAIXA(this->SP, i) = sp - 1;
+                C8_FAIXA(this->PC, i) = C8_FAIXA(this->stack[sp - 1], i);
+            }
+            this->DesviarPorInstancia();
+            break;
+        case OP_BNNN:
+            for (int i = this->ref; i < this->n; i++) {
+                if (C8_FAIXA(this->ativa8, i)) C8_FAIXA(this->PC, i) = d.NNN + C8_FAIXA(this->V[Q::salto_vx ? d.X : 0], i);
+            }
+            this->DesviarPorInstancia();
+            break;
+
+        // Skips: a condição é calculada em todas as instâncias de uma vez
+        case OP_3XNN:
+            for (int b = 0; b < this->nb; b++) this->cond[b] = (Faixa8)(vx[b] == d.NN);
+            this->Desviar(pc_skip, pc + 2);
+            break;
+        case OP_4XNN:
+            for (int b = 0; b < this->nb; b++) this->cond[b] = (Faixa8)(vx[b] != d.NN);
+            this->Desviar(pc_skip, pc + 2);
+            break;
+        case OP_5XY0:
+            for (int b = 0; b < this->nb; b++) this->cond[b] = (Faixa8)(vx[b] == vy[b]);
+            this->Desviar(pc_skip, pc + 2);
+            break;
+        case OP_9XY0:
+            for (int b = 0; b < this->nb; b++) this->cond[b] = (Faixa8)(vx[b] != vy[b]);
+            this->Desviar(pc_skip, pc + 2);
+            break;
+        case OP_EX9E:
+        case OP_EXA1:
+            for (int i = this->ref; i < this->n; i++) {
+                uint8_t k = C8_FAIXA(vx, i);
+                bool apertada = k < CHIP8_KEYS && this->vms[i].KEY[k] == 1;
+                bool solta = k < CHIP8_KEYS && this->vms[i].KEY[k] == 0;
+                C8_FAIXA(this->cond, i) = (d.op == OP_EX9E ? apertada : solta) ? 0xFF : 0;
+            }
+            this->Desviar(pc_skip, pc + 2);
+            break;
+        case OP_FX0A:
+            for (int i = this->ref; i < this->n; i++) {
+                C8_FAIXA(this->cond, i) = 0;
+                if (!C8_FAIXA(this->ativa8, i)) continue;
+                for (int k = 0; k < CHIP8_KEYS; k++) {
+                    if (this->vms[i].KEY[k] == 1) {
+                        C8_FAIXA(vx, i) = k;
+                        C8_FAIXA(this->cond, i) = 0xFF;
+                        break;
+                    }
+                }
+            }
+            this->Desviar(pc + 2, pc);
+            break;
+
+        // ALU: mesma ordem de leituras/escritas de c8ops.h (importa quando X ou Y é F)
+        case OP_6XNN:
+            for (int b = 0; b < this->nb; b++) vx[b] = mesclar8(vx[b] * 0 + d.NN, vx[b], this->ativa8[b]);
+            break;
+        case OP_7XNN:
+            for (int b = 0; b < this->nb; b++) vx[b] = mesclar8(vx[b] + d.NN, vx[b], this->ativa8[b]);
+            break;
+        case OP_8XY0:
+            for (int b = 0; b < this->nb; b++) vx[b] = mesclar8(vy[b], vx[b], this->ativa8[b]);
+            break;
+        case OP_8XY1:
+            for (int b = 0; b < this->nb; b++) {
+                vx[b] = mesclar8(vx[b] | vy[b], vx[b], this->ativa8[b]);
+                if (Q::reset_vf) vf[b] = mesclar8(vf[b] * 0, vf[b], this->ativa8[b]);
+            }
+            break;
+        case OP_8XY2:
+            for (int b = 0; b < this->nb; b++) {
+                vx[b] = mesclar8(vx[b] & vy[b], vx[b], this->ativa8[b]);
+                if (Q::reset_vf) vf[b] = mesclar8(vf[b] * 0, vf[b], this->ativa8[b]);
+            }
+            break;
+        case OP_8XY3:
+            for (int b = 0; b < this->nb; b++) {
+                vx[b] = mesclar8(vx[b] ^ vy[b], vx[b], this->ativa8[b]);
+                if (Q::reset_vf) vf[b] = mesclar8(vf[b] * 0, vf[b], this->ativa8[b]);
+            }
+            break;
+        case OP_8XY4:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa8 m = this->ativa8[b];
+                Faixa8 soma = vx[b] + vy[b];
+                vf[b] = mesclar8((Faixa8)(soma < vx[b]) & 1, vf[b], m);
+                vx[b] = mesclar8(soma, vx[b], m);
+            }
+            break;
+        case OP_8XY5:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa8 m = this->ativa8[b];
+                vf[b] = mesclar8((Faixa8)(vx[b] > vy[b]) & 1, vf[b], m);
+                vx[b] = mesclar8(vx[b] - vy[b], vx[b], m);
+            }
+            break;
+        case OP_8XY6:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa8 m = this->ativa8[b];
+                vf[b] = mesclar8(vs[b] & 1, vf[b], m);
+                vx[b] = mesclar8(vs[b] >> 1, vx[b], m);
+            }
+            break;
+        case OP_8XY7:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa8 m = this->ativa8[b];
+                vf[b] = mesclar8((Faixa8)(vy[b] > vx[b]) & 1, vf[b], m);
+                vx[b] = mesclar8(vy[b] - vx[b], vx[b], m);
+            }
+            break;
+        case OP_8XYE:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa8 m = this->ativa8[b];
+                vf[b] = mesclar8(vs[b] >> 7, vf[b], m);
+                vx[b] = mesclar8(vs[b] << 1, vx[b], m);
+            }
+            break;
+        case OP_ANNN:
+            for (int b = 0; b < this->nb; b++) {
+                this->I[b] = mesclar16(this->I[b] * 0 + d.NNN, this->I[b], this->ativa16[b]);
+            }
+            break;
+        case OP_FX1E:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa16 v = __builtin_convertvector(vx[b], Faixa16);
+                this->I[b] = mesclar16(this->I[b] + v, this->I[b], this->ativa16[b]);
+            }
+            break;
+        case OP_FX29:
+            for (int b = 0; b < this->nb; b++) {
+                Faixa16 v = __builtin_convertvector(vx[b], Faixa16);
+                this->I[b] = mesclar16(v * 5, this->I[b], this->ativa16[b]);
+            }
+            break;
+        case OP_FX07:
+            for (int b = 0; b < this->nb; b++) vx[b] = mesclar8(this->delay_timer[b], vx[b], this->ativa8[b]);
+            break;
+        case OP_FX15:
+            for (int b = 0; b < this->nb; b++) {
+                this->delay_timer[b] = mesclar8(vx[b], this->delay_timer[b], this->ativa8[b]);
+            }
+            break;
+        case OP_FX18:
+            for (int b = 0; b < this->nb; b++) {
+                this->sound_timer[b] = mesclar8(vx[b], this->sound_timer[b], this->ativa8[b]);
+            }
+            break;
+
+        // RAM, tela e gerador: instância por instância
+        case OP_00E0:
+        case OP_00CN:
+        case OP_00DN:
+        case OP_00FB:
+        case OP_00FC:
+        case OP_00FE:
+        case OP_00FF:
+        case OP_5XY2:
+        case OP_5XY3:
+        case OP_CXNN:
+        case OP_DXYN:
+        case OP_FN01:
+        case OP_F002:
+        case OP_FX30:
+        case OP_FX33:
+        case OP_FX3A:
+        case OP_FX55:
+        case OP_FX65:
+        case OP_FX75:
+        case OP_FX85:
+            this->ExecutarNasInstancias<Q>(d);
+            break;
+
+        default: // OP_INVALIDA
+            for (int i = this->ref; i < this->n; i++) {
+                if (C8_FAIXA(this->ativa8, i)) this->Desativar(i, VM_ERRO_OPCODE_INVALIDO, pc);
+            }
+            break;
+        }
+
+        if (this->em_vms || this->ativas == 0) return feitos;
+    }
+    return feitos;
+}
@@ -0,0 +1,115 @@
+#ifndef C8GRUPO_H
+#define C8GRUPO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "c8vm.h"
+#include "c8decod.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Grupo de várias instâncias da MESMA ROM executando em lock-step (para
+// fuzzing e busca, onde só a entrada/semente muda entre as instâncias).
+//
+// Enquanto todas as instâncias ativas estão no mesmo PC, os registradores
+// ficam em "structure of arrays" (V[x] de todas as instâncias lado a lado)
+// e cada instrução é decodificada uma vez e executada com operações
+// vetoriais de GRUPO_LARGURA instâncias por vez (SSE2; AVX2 com
+// "make NATIVO=1"). RAM, tela e teclado continuam em um VM por instância.
+// Quando os PCs divergem (skip, BNNN, 00EE, FX0A...), os registradores
+// voltam para os VMs e cada instância anda sozinha em janelas de
+// GRUPO_JANELA_ESCALAR ciclos até os PCs se reencontrarem.
+//
+// Usa os vetores do GCC/Clang (__attribute__((vector_size))).
+#define GRUPO_LARGURA 32
+#define GRUPO_JANELA_ESCALAR 32
+
+typedef uint8_t  Faixa8  __attribute__((vector_size(GRUPO_LARGURA)));
+typedef uint16_t Faixa16 __attribute__((vector_size(GRUPO_LARGURA * 2)));
+
+class GrupoVM {
+public:
+    explicit GrupoVM(int instancias);
+
+    int Instancias() const { return this->n; }
+
+    // Inicializa todas as instâncias (e zera as estatísticas) e carrega a
+    // mesma ROM em todas
+    void Inicializar(uint16_t pc_inicial);
+    // Em caso de erro (veja VM::VM_CarregarROM) as instâncias não são
+    // alteradas. A ROM tem que caber na RAM do perfil: chame DefinirQuirks antes.
+    bool CarregarROM(const char* arq_rom, uint16_t pc_inicial, std::string* erro);
+
+    // Perfil de quirks de todas as instâncias (Inicializar volta para
+    // VM_QUIRKS_PADRAO). Deve ser o mesmo em todas. Falha como
+    // VM::VM_DefinirQuirks, sem alterar as instâncias.
+    bool DefinirQuirks(VM_Quirks quirks, std::string* erro);
+
+    // Executa 'ciclos' instruções em cada instância ativa. Uma instância que
+    // falha para no ponto da falha (veja Status) e sai do lock-step.
+    // Retorna quantas instâncias continuam ativas.
+    int Executar(uint64_t ciclos);
+
+    void ProcessarTimers();
+    void ProcessarInput(int instancia, uint8_t key_index, bool is_down);
+
+    VM_Status Status(int instancia) const { return this->status[instancia]; }
+
+    // VM completo da instância (registradores sincronizados). Pode ser
+    // alterado; a próxima execução parte do que estiver no VM. A RAM das
+    // instâncias não deve ser alterada por fora.
+    VM& Instancia(int instancia);
+
+    // Estatísticas: ciclos (somados entre as instâncias) executados em
+    // lock-step e instância por instância
+    uint64_t ciclos_vetoriais;
+    uint64_t ciclos_escalares;
+
+private:
+    int n;            // Instâncias
+    int nb;           // Blocos de GRUPO_LARGURA instâncias
+    int ativas;
+    int ref;          // Primeira instância ativa (de onde vem a instrução)
+
+    std::vector<VM> vms;
+    std::vector<VM_Status> status;
+
+    // true = registradores estão nos VMs (execução escalar);
+    // false = estão nos vetores abaixo e todas as ativas estão em pc_comum
+    bool em_vms;
+    uint16_t pc_comum;
+
+    std::vector<Faixa8> V[16];
+    std::vector<Faixa8> SP;
+    std::vector<Faixa8> delay_timer;
+    std::vector<Faixa8> sound_timer;
+    std::vector<Faixa16> I;
+    std::vector<Faixa16> PC;          // Só vale na transição para os VMs
+    std::vector<Faixa16> stack[16];
+    std::vector<Faixa8> ativa8;       // 0xFF = instância ativa
+    std::vector<Faixa16> ativa16;
+    std::vector<Faixa8> cond;         // Resultado de skips por instância
+
+    // Endereços já escritos por FX33/FX55 em alguma instância: ali o código
+    // pode ser diferente entre as instâncias
+    uint8_t escrito[VM_TAM_RAM];
+
+    // Decodificação compartilhada entre as instâncias, só usada onde
+    // escrito[] está zerado (ali a RAM é igual em todas)
+    OpDecodificada decod[VM_TAM_RAM];
+
+    void Desativar(int i, VM_Status st, uint16_t pc);
+    void Espalhar(bool usar_pc_comum);
+    void Reunir();
+    bool Convergiu();
+    void Desviar(uint16_t pc_sim, uint16_t pc_nao);
+    void DesviarPorInstancia();
+
+    // Especializadas por perfil de quirks (veja C8_Quirks)
+    template<class Q> int ExecutarCom(uint64_t ciclos);
+    template<class Q> uint64_t ExecutarVetorial(uint64_t ciclos);
+    template<class Q> void ExecutarNasInstancias(const OpDecodificada& d);
+};
+
+#endif
@@ -0,0 +1,132 @@
+#include "c8historico.h"
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+static void por_varint(std::vector<uint8_t>& saida, size_t v) {
+    while (v >= 0x80) {
+        saida.push_back((v & 0x7F) | 0x80);
+        v >>= 7;
+    }
+    saida.push_back(v);
+}
+
+static size_t ler_varint(const uint8_t** p) {
+    size_t v = 0;
+    int desloc = 0;
+    uint8_t b;
+    do {
+        b = *(*p)++;
+        v |= (size_t)(b & 0x7F) << desloc;
+        desloc += 7;
+    } while (b & 0x80);
+    return v;
+}
+
+// Codifica dados ^ ref (ref NULL = zeros) como pares
+// <zeros: varint> <literais: varint> <bytes literais>
+static void rle_codificar(const uint8_t* dados, const uint8_t* ref, size_t tam, std::vector<uint8_t>& saida) {
+    size_t i = 0;
+    while (i < tam) {
+        size_t zeros = 0;
+        while (i < tam && (dados[i] ^ (ref ? ref[i] : 0)) == 0) {
+            zeros++;
+            i++;
+        }
+        size_t lit = i;
+        // Um zero isolado no meio de literais sai mais barato como literal
+        while (lit < tam && ((dados[lit] ^ (ref ? ref[lit] : 0)) != 0 ||
+                             (lit + 1 < tam && (dados[lit + 1] ^ (ref ? ref[lit + 1] : 0)) != 0))) {
+            lit++;
+        }
+        por_varint(saida, zeros);
+        por_varint(saida, lit - i);
+        for (; i < lit; i++) saida.push_back(dados[i] ^ (ref ? ref[i] : 0));
+    }
+}
+
+// saida = ref ^ decodificado (ref NULL = zeros)
+static void rle_decodificar(const uint8_t* p, const uint8_t* ref, size_t tam, uint8_t* saida) {
+    size_t i = 0;
+    while (i < tam) {
+        size_t zeros = ler_varint(&p);
+        if (ref) memcpy(saida + i, ref + i, zeros);
+        else memset(saida + i, 0, zeros);
+        i += zeros;
+
+        size_t lit = ler_varint(&p);
+        for (size_t k = 0; k < lit; k++, i++) saida[i] = *p++ ^ (ref ? ref[i] : 0);
+    }
+}
+
+HistoricoVM::HistoricoVM(size_t max_quadros) {
+    this->max_quadros = max_quadros < 2 ? 2 : max_quadros;
+    this->total_quadros = 0;
+}
+
+void HistoricoVM::Limpar() {
+    this->grupos.clear();
+    this->total_quadros = 0;
+}
+
+size_t HistoricoVM::BytesUsados() const {
+    size_t total = 0;
+    for (size_t g = 0; g < this->grupos.size(); g++) {
+        const Grupo& gr = this->grupos[g];
+        total += gr.chave.capacity() + gr.deltas.capacity() + gr.inicio.capacity() * sizeof(uint32_t);
+    }
+    return total;
+}
+
+void HistoricoVM::Gravar(const VM& vm) {
+    size_t tam = Estado_Tamanho(vm);
+    if (this->grupos.empty() || this->grupos.back().inicio.size() + 1 >= HISTORICO_QUADROS_POR_CHAVE ||
+        this->grupos.back().tam != tam) {
+        // Novo estado-chave
+        this->grupos.push_back(Grupo());
+        this->grupos.back().tam = tam;
+        this->chave_atual.resize(tam);
+        Estado_Salvar(vm, this->chave_atual.data());
+        rle_codificar(this->chave_atual.data(), NULL, tam, this->grupos.back().chave);
+        this->grupos.back().chave.shrink_to_fit();
+    } else {
+        Grupo& g = this->grupos.back();
+        this->tmp.resize(tam);
+        Estado_Salvar(vm, this->tmp.data());
+        g.inicio.push_back(g.deltas.size());
+        rle_codificar(this->tmp.data(), this->chave_atual.data(), tam, g.deltas);
+    }
+    this->total_quadros++;
+
+    // Descarta o grupo mais antigo inteiro (nunca o que está sendo gravado)
+    while (this->total_quadros > this->max_quadros && this->grupos.size() > 1) {
+        this->total_quadros -= 1 + this->grupos.front().inicio.size();
+        this->grupos.pop_front();
+    }
+}
+
+bool HistoricoVM::Voltar(VM& vm) {
+    if (this->total_quadros < 2) return false;
+
+    // Descarta o quadro mais recente
+    Grupo& ultimo = this->grupos.back();
+    if (!ultimo.inicio.empty()) {
+        ultimo.deltas.resize(ultimo.inicio.back());
+        ultimo.inicio.pop_back();
+    } else {
+        this->grupos.pop_back();
+        this->chave_atual.resize(this->grupos.back().tam);
+        rle_decodificar(this->grupos.back().chave.data(), NULL, this->grupos.back().tam, this->chave_atual.data());
+    }
+    this->total_quadros--;
+
+    // Restaura o que ficou por último
+    const Grupo& g = this->grupos.back();
+    this->tmp.resize(g.tam);
+    if (g.inicio.empty()) {
+        memcpy(this->tmp.data(), this->chave_atual.data(), g.tam);
+    } else {
+        rle_decodificar(g.deltas.data() + g.inicio.back(), this->chave_atual.data(), g.tam, this->tmp.data());
+    }
+    return Estado_Carregar(vm, this->tmp.data(), g.tam, NULL);
+}
@@ -0,0 +1,58 @@
+#ifndef C8HISTORICO_H
+#define C8HISTORICO_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include <deque>
+#include <vector>
+#include "c8vm.h"
+#include "c8estado.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Histórico de estados para voltar no tempo quadro a quadro.
+//
+// A cada HISTORICO_QUADROS_POR_CHAVE quadros é gravado um estado-chave
+// completo; os quadros seguintes guardam só o XOR com essa chave, com as
+// sequências de zeros comprimidas (RLE). Como a diferença é sempre contra
+// a chave e não contra o quadro anterior, qualquer quadro volta com uma
+// decodificação só. Quando passa de 'max_quadros', o grupo mais antigo é
+// descartado. Se o tamanho do estado muda (a VM passou a usar os 64KB do
+// XO-CHIP), começa um grupo novo.
+#define HISTORICO_QUADROS_POR_CHAVE 60
+
+class HistoricoVM {
+public:
+    explicit HistoricoVM(size_t max_quadros);
+
+    // Grava o estado atual como o quadro mais recente
+    void Gravar(const VM& vm);
+
+    // Descarta o quadro mais recente e restaura na VM o anterior (que passa
+    // a ser o mais recente). Retorna false se não houver quadro anterior.
+    // Como em Estado_Carregar, o motor da VM precisa de InvalidarTudo().
+    bool Voltar(VM& vm);
+
+    void Limpar();
+
+    size_t Quadros() const { return this->total_quadros; }
+    size_t BytesUsados() const;
+
+private:
+    struct Grupo {
+        size_t tam;                      // Tamanho dos estados do grupo
+        std::vector<uint8_t> chave;      // Estado-chave (RLE)
+        std::vector<uint8_t> deltas;     // XOR com a chave (RLE), um após o outro
+        std::vector<uint32_t> inicio;    // Onde cada delta começa em 'deltas'
+    };
+
+    std::deque<Grupo> grupos;
+    size_t max_quadros;
+    size_t total_quadros;
+
+    // Estado-chave do último grupo, já decodificado
+    std::vector<uint8_t> chave_atual;
+    std::vector<uint8_t> tmp;
+};
+
+#endif
@@ -0,0 +1,16 @@
+#include "c8motor.h"
+#include "c8cache.h"
+#include "c8blocos.h"
+#include "c8aot.h"
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+Motor* Motor_Criar(const char* nome) {
+    if (strcmp(nome, "interpretador") == 0) return new MotorInterpretador();
+    if (strcmp(nome, "cache") == 0) return new MotorCache();
+    if (strcmp(nome, "blocos") == 0) return new MotorBlocos();
+    // Só no executável com ROMs recompiladas (veja c8aot.h)
+    if (strcmp(nome, "aot") == 0 && AOT_NumProgramas() > 0) return new MotorAOT();
+    return NULL;
+}
@@ -0,0 +1,49 @@
+#ifndef C8MOTOR_H
+#define C8MOTOR_H
+
+#include <stdint.h>
+#include "c8vm.h"
+
+struct AnaliseROM;
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Interface comum dos motores de execução. Todos executam a mesma
+// semântica (c8ops.h) e devem deixar a VM exatamente no mesmo estado que
+// VM::VM_ExecutarCiclos para o mesmo número de ciclos.
+class Motor {
+public:
+    // Ciclos dados como executados sem executar nada (esperas ocupadas,
+    // veja C8_CiclosEmEspera), somados desde a criação. Quem mede vazão
+    // desconta estes ciclos; o interpretador nunca pula.
+    uint64_t ciclos_em_espera;
+
+    Motor() : ciclos_em_espera(0) {}
+    virtual ~Motor() {}
+
+    virtual VM_Status Executar(VM& vm, uint64_t ciclos) = 0;
+
+    // Descarta qualquer tradução/decodificação guardada. Necessário quando
+    // a RAM da VM é alterada por fora do motor.
+    virtual void InvalidarTudo() {}
+
+    // Decodifica/traduz de antemão o código alcançável da ROM (veja
+    // c8analise.h), para os primeiros quadros não pagarem a tradução. A VM
+    // deve estar com a RAM da análise e o perfil de quirks já definido.
+    virtual void Preaquecer(const VM& vm, const AnaliseROM& analise) { (void)vm; (void)analise; }
+};
+
+// Interpretador de referência: um VM_ExecutarInstrucao por ciclo
+class MotorInterpretador : public Motor {
+public:
+    VM_Status Executar(VM& vm, uint64_t ciclos) { return vm.VM_ExecutarCiclos(ciclos); }
+};
+
+#define MOTORES_DISPONIVEIS "interpretador, cache, blocos"
+#define MOTOR_PADRAO "cache"
+
+// Cria o motor pelo nome (veja MOTORES_DISPONIVEIS; "aot" também, no
+// executável de "make aot"). Retorna NULL se o nome for desconhecido. O chamador libera com delete.
+Motor* Motor_Criar(const char* nome);
+
+#endif
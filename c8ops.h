@@ -0,0 +1,672 @@
+#ifndef C8OPS_H
+#define C8OPS_H
+
+#include <stdlib.h>
+#include <string.h>
+#include "c8vm.h"
+#include "c8decod.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Semântica de cada instrução, compartilhada por todos os motores de
+// execução (interpretador em c8vm.cpp e os motores de c8motor.h).
+// Quando a função é chamada o PC já foi incrementado; saltos/chamadas
+// sobrescrevem o PC. Em caso de falha o PC volta para a instrução que falhou.
+
+// Comportamento de cada perfil de quirks (veja VM_Quirks em c8vm.h). São
+// constantes de compilação: os motores instanciam o laço de execução uma
+// vez por perfil (C8_DESPACHAR_QUIRKS) e as operações recebem o perfil como
+// parâmetro de template, então os testes de quirk somem do código gerado.
+enum C8_IncrementoI {
+    C8_I_FIXO,      // FX55/FX65 não mudam I
+    C8_I_MAIS_X,    // I += X (CHIP-48)
+    C8_I_MAIS_X1    // I += X + 1 (VIP, XO-CHIP)
+};
+
+template<int PERFIL> struct C8_Quirks;
+
+#define C8_DEFINIR_QUIRKS(PERFIL, DESLOCA_VY, INCREMENTO_I, SALTO_VX, RESET_VF, RECORTE, EXTENSAO) \
+    template<> struct C8_Quirks<PERFIL> {                                               \
+        static constexpr int perfil = PERFIL;                                           \
+        static constexpr bool desloca_vy = DESLOCA_VY;     /* 8XY6/8XYE leem VY */       \
+        static constexpr int incremento_i = INCREMENTO_I;  /* FX55/FX65 */               \
+        static constexpr bool salto_vx = SALTO_VX;         /* BNNN vira BXNN */          \
+        static constexpr bool reset_vf = RESET_VF;         /* 8XY1/8XY2/8XY3 zeram VF */ \
+        static constexpr bool recorte = RECORTE;           /* DXYN corta na borda */     \
+        static constexpr int extensao = EXTENSAO;          /* VM_Extensao */             \
+    };
+
+//                vy     incremento de I  BXNN   VF = 0  recorte extensões
+C8_DEFINIR_QUIRKS(VM_QUIRKS_PADRAO,  false, C8_I_FIXO,    false, false, true,  VM_EXT_CHIP8)
+C8_DEFINIR_QUIRKS(VM_QUIRKS_VIP,     true,  C8_I_MAIS_X1, false, true,  true,  VM_EXT_CHIP8)
+C8_DEFINIR_QUIRKS(VM_QUIRKS_CHIP48,  false, C8_I_MAIS_X,  true,  false, true,  VM_EXT_CHIP8)
+C8_DEFINIR_QUIRKS(VM_QUIRKS_SCHIP,   false, C8_I_FIXO,    true,  false, true,  VM_EXT_SCHIP)
+C8_DEFINIR_QUIRKS(VM_QUIRKS_MODERNO, true,  C8_I_MAIS_X1, false, false, false, VM_EXT_XOCHIP)
+#undef C8_DEFINIR_QUIRKS
+
+// Executa 'return CHAMADA;' com o tipo Q = C8_Quirks do perfil 'quirks'.
+// É o único desvio pelo perfil: fica fora do laço de execução.
+#define C8_DESPACHAR_QUIRKS(quirks, CHAMADA)                                            \
+    switch (quirks) {                                                                   \
+        case VM_QUIRKS_VIP:     { typedef C8_Quirks<VM_QUIRKS_VIP> Q; return CHAMADA; }     \
+        case VM_QUIRKS_CHIP48:  { typedef C8_Quirks<VM_QUIRKS_CHIP48> Q; return CHAMADA; }  \
+        case VM_QUIRKS_SCHIP:   { typedef C8_Quirks<VM_QUIRKS_SCHIP> Q; return CHAMADA; }   \
+        case VM_QUIRKS_MODERNO: { typedef C8_Quirks<VM_QUIRKS_MODERNO> Q; return CHAMADA; } \
+        default:                { typedef C8_Quirks<VM_QUIRKS_PADRAO> Q; return CHAMADA; }  \
+    }
+
+// Endereço na RAM a partir de I ou do PC: dá a volta no fim da memória da
+// VM (tam_ram é potência de 2), como o barramento de endereços de 12 bits
+// do CHIP-8 (16 no XO-CHIP). Assim nenhum acesso sai do vetor RAM, seja
+// qual for a ROM, e sem teste de limite.
+inline uint32_t C8_Endereco(const VM& vm, uint32_t endereco) {
+    return endereco & (vm.tam_ram - 1);
+}
+
+// Marca as páginas da RAM cobertas por [inicio, inicio + tam), dando a
+// volta no fim da memória como C8_Endereco
+inline void C8_MarcarPaginas(VM& vm, uint32_t inicio, uint32_t tam) {
+    inicio = C8_Endereco(vm, inicio);
+    if (inicio + tam > vm.tam_ram) {
+        C8_MarcarPaginas(vm, 0, inicio + tam - vm.tam_ram);
+        tam = vm.tam_ram - inicio;
+    }
+    int de = inicio / VM_TAM_PAGINA;
+    int ate = (inicio + tam - 1) / VM_TAM_PAGINA;
+    for (int p = de; p <= ate; p++) vm.paginas_alteradas[p / 64] |= 1ULL << (p % 64);
+}
+
+// Extensão que uma operação exige (VM_Extensao). Operações do CHIP-8 (e a
+// OP_INVALIDA) dão VM_EXT_CHIP8.
+inline int C8_ExtensaoOp(uint8_t op) {
+    switch (op) {
+        case OP_00CN: case OP_00FB: case OP_00FC: case OP_00FD: case OP_00FE: case OP_00FF:
+        case OP_FX30: case OP_FX75: case OP_FX85:
+            return VM_EXT_SCHIP;
+        case OP_00DN: case OP_5XY2: case OP_5XY3: case OP_F000: case OP_FN01: case OP_F002: case OP_FX3A:
+            return VM_EXT_XOCHIP;
+        default:
+            return VM_EXT_CHIP8;
+    }
+}
+
+// No início de cada operação de extensão: fora dos perfis que a habilitam
+// ela é uma instrução inválida (veja op_INVALIDA). O teste é de compilação.
+#define C8_EXIGIR_EXTENSAO(OP)                                                          \
+    do {                                                                                \
+        if (Q::extensao < C8_ExtensaoOp(OP)) {                                          \
+            vm.PC -= 2;                                                                 \
+            return VM_ERRO_OPCODE_INVALIDO;                                             \
+        }                                                                               \
+    } while (0)
+
+// Pula a próxima instrução (skips). O F000 NNNN do XO-CHIP ocupa 4 bytes
+// e é pulado inteiro; nos outros perfis ele é uma instrução comum.
+template<class Q> inline void C8_Pular(VM& vm) {
+    uint32_t pc = vm.PC;
+    bool longa = Q::extensao >= VM_EXT_XOCHIP &&
+                 vm.RAM[C8_Endereco(vm, pc)] == 0xF0 && vm.RAM[C8_Endereco(vm, pc + 1)] == 0x00;
+    vm.PC += longa ? 4 : 2;
+}
+
+// Próximo byte do gerador da VM (xorshift32; usa os bits altos, que são os
+// de melhor qualidade)
+inline uint8_t C8_Aleatorio(VM& vm) {
+    uint32_t x = vm.rng;
+    x ^= x << 13;
+    x ^= x >> 17;
+    x ^= x << 5;
+    vm.rng = x;
+    return (uint8_t)(x >> 24);
+}
+
+// Veja VM::VM_EmEspera. Padrões reconhecidos, sempre a partir do PC:
+//   1NNN para o próprio endereço                          (laço de 1 ciclo)
+//   FX0A sem nenhuma tecla apertada                       (laço de 1 ciclo)
+//   FX07 / 3XNN ou 4XNN com o mesmo X / 1NNN para o FX07   (laço de 3 ciclos)
+// No último, VX já precisa valer o delay_timer e o skip não pode pular o
+// salto: assim cada volta deixa a VM exatamente como estava.
+inline VM_Espera C8_Espera(const VM& vm) {
+    // PC ainda não mascarado (passou do fim da memória): a próxima busca
+    // o traz de volta, o que muda o estado
+    uint16_t pc = vm.PC;
+    if (pc >= vm.tam_ram) return VM_ESPERA_NENHUMA;
+    uint16_t inst = (vm.RAM[pc] << 8) | vm.RAM[C8_Endereco(vm, pc + 1)];
+
+    if (inst == (0x1000 | pc)) return VM_ESPERA_ENTRADA;
+
+    if ((inst & 0xF0FF) == 0xF00A) {
+        for (int k = 0; k < CHIP8_KEYS; k++) {
+            if (vm.KEY[k]) return VM_ESPERA_NENHUMA;
+        }
+        return VM_ESPERA_ENTRADA;
+    }
+
+    if ((inst & 0xF0FF) == 0xF007 && (uint32_t)pc + 5 < vm.tam_ram) {
+        uint8_t x = (inst >> 8) & 0xF;
+        uint16_t skip = (vm.RAM[pc + 2] << 8) | vm.RAM[pc + 3];
+        uint16_t salto = (vm.RAM[pc + 4] << 8) | vm.RAM[pc + 5];
+        if (salto != (0x1000 | pc) || vm.V[x] != vm.delay_timer) return VM_ESPERA_NENHUMA;
+        if ((skip & 0xFF00) == (0x3000 | (x << 8)) && vm.delay_timer != (skip & 0xFF)) return VM_ESPERA_TIMER;
+        if ((skip & 0xFF00) == (0x4000 | (x << 8)) && vm.delay_timer == (skip & 0xFF)) return VM_ESPERA_TIMER;
+    }
+    return VM_ESPERA_NENHUMA;
+}
+
+// Quantos dos 'restantes' ciclos podem ser dados como executados sem
+// executar nada: voltas inteiras do laço de espera em que o PC está. Os
+// motores chamam depois de 1NNN e FX0A, as únicas instruções que fecham
+// esses laços; os timers e o teclado não mudam dentro de um Executar.
+inline uint64_t C8_CiclosEmEspera(const VM& vm, uint64_t restantes) {
+    switch (C8_Espera(vm)) {
+        case VM_ESPERA_ENTRADA: return restantes;
+        case VM_ESPERA_TIMER:   return restantes - restantes % 3;
+        default:                return 0;
+    }
+}
+
+template<class Q> inline VM_Status op_0NNN(VM&, const OpDecodificada&) {
+    // 0NNN (SYS) é ignorada, como na maioria dos interpretadores
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00E0(VM& vm, const OpDecodificada&) {
+    // 00E0: Limpa a tela (os planos selecionados)
+    for (int p = 0; p < VM_PLANOS; p++) {
+        if (vm.planos & (1 << p)) memset(vm.DISPLAY[p], 0, sizeof(vm.DISPLAY[p]));
+    }
+    vm.linhas_alteradas = ~0ULL;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00EE(VM& vm, const OpDecodificada&) {
+    // 00EE: Retorna de uma sub-rotina
+    if (vm.SP == 0) {
+        vm.PC -= 2;
+        return VM_ERRO_PILHA_VAZIA;
+    }
+    vm.SP--;
+    vm.PC = vm.stack[vm.SP];
+    return VM_OK;
+}
+
+// Rolagem da tela (SUPER-CHIP/XO-CHIP), nos planos selecionados. Como
+// cada linha são uma (lores) ou duas (hires) palavras, rolar na vertical é
+// um memmove e na horizontal são shifts de palavra inteira.
+
+// Rola 'n' linhas para baixo (n > 0) ou para cima (n < 0)
+inline void C8_RolarVertical(VM& vm, int n) {
+    int por_linha = vm.hires ? 2 : 1;
+    int total = vm.VM_Altura() * por_linha;
+    int desloc = (n < 0 ? -n : n) * por_linha;
+    if (desloc > total) desloc = total;
+    for (int p = 0; p < VM_PLANOS; p++) {
+        if (!(vm.planos & (1 << p))) continue;
+        uint64_t* tela = vm.DISPLAY[p];
+        if (n > 0) {
+            memmove(tela + desloc, tela, (total - desloc) * sizeof(uint64_t));
+            memset(tela, 0, desloc * sizeof(uint64_t));
+        } else {
+            memmove(tela, tela + desloc, (total - desloc) * sizeof(uint64_t));
+            memset(tela + total - desloc, 0, desloc * sizeof(uint64_t));
+        }
+    }
+    vm.linhas_alteradas = ~0ULL;
+}
+
+// Rola 4 pixels para a direita (n > 0) ou para a esquerda (n < 0)
+inline void C8_RolarHorizontal(VM& vm, int n) {
+    for (int p = 0; p < VM_PLANOS; p++) {
+        if (!(vm.planos & (1 << p))) continue;
+        uint64_t* tela = vm.DISPLAY[p];
+        if (!vm.hires) {
+            for (int y = 0; y < 32; y++) tela[y] = n > 0 ? tela[y] >> 4 : tela[y] << 4;
+        } else if (n > 0) {
+            for (int y = 0; y < 128; y += 2) {
+                tela[y + 1] = (tela[y + 1] >> 4) | (tela[y] << 60);
+                tela[y] >>= 4;
+            }
+        } else {
+            for (int y = 0; y < 128; y += 2) {
+                tela[y] = (tela[y] << 4) | (tela[y + 1] >> 60);
+                tela[y + 1] <<= 4;
+            }
+        }
+    }
+    vm.linhas_alteradas = ~0ULL;
+}
+
+template<class Q> inline VM_Status op_00CN(VM& vm, const OpDecodificada& d) {
+    // 00CN: Rola a tela N linhas para baixo
+    C8_EXIGIR_EXTENSAO(OP_00CN);
+    C8_RolarVertical(vm, d.N);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00DN(VM& vm, const OpDecodificada& d) {
+    // 00DN: Rola a tela N linhas para cima (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_00DN);
+    C8_RolarVertical(vm, -d.N);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00FB(VM& vm, const OpDecodificada&) {
+    // 00FB: Rola a tela 4 pixels para a direita
+    C8_EXIGIR_EXTENSAO(OP_00FB);
+    C8_RolarHorizontal(vm, 1);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00FC(VM& vm, const OpDecodificada&) {
+    // 00FC: Rola a tela 4 pixels para a esquerda
+    C8_EXIGIR_EXTENSAO(OP_00FC);
+    C8_RolarHorizontal(vm, -1);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00FD(VM& vm, const OpDecodificada&) {
+    // 00FD: Encerra o programa (fica parado nesta instrução)
+    C8_EXIGIR_EXTENSAO(OP_00FD);
+    vm.PC -= 2;
+    return VM_PROGRAMA_ENCERRADO;
+}
+
+// 00FE/00FF: Troca para 64x32 / 128x64. A tela inteira é limpa.
+inline VM_Status C8_MudarResolucao(VM& vm, uint8_t hires) {
+    vm.hires = hires;
+    memset(vm.DISPLAY, 0, sizeof(vm.DISPLAY));
+    vm.linhas_alteradas = ~0ULL;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_00FE(VM& vm, const OpDecodificada&) {
+    C8_EXIGIR_EXTENSAO(OP_00FE);
+    return C8_MudarResolucao(vm, 0);
+}
+
+template<class Q> inline VM_Status op_00FF(VM& vm, const OpDecodificada&) {
+    C8_EXIGIR_EXTENSAO(OP_00FF);
+    return C8_MudarResolucao(vm, 1);
+}
+
+template<class Q> inline VM_Status op_1NNN(VM& vm, const OpDecodificada& d) {
+    // 1NNN: Pula para o endereço NNN
+    vm.PC = d.NNN;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_2NNN(VM& vm, const OpDecodificada& d) {
+    // 2NNN: Chama sub-rotina em NNN
+    if (vm.SP >= 16) {
+        vm.PC -= 2;
+        return VM_ERRO_PILHA_CHEIA;
+    }
+    vm.stack[vm.SP++] = vm.PC;
+    vm.PC = d.NNN;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_3XNN(VM& vm, const OpDecodificada& d) {
+    // 3XNN: Pula a próxima instrução se VX == NN
+    if (vm.V[d.X] == d.NN) C8_Pular<Q>(vm);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_4XNN(VM& vm, const OpDecodificada& d) {
+    // 4XNN: Pula a próxima instrução se VX != NN
+    if (vm.V[d.X] != d.NN) C8_Pular<Q>(vm);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_5XY0(VM& vm, const OpDecodificada& d) {
+    // 5XY0: Pula a próxima instrução se VX == VY
+    if (vm.V[d.X] == vm.V[d.Y]) C8_Pular<Q>(vm);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_5XY2(VM& vm, const OpDecodificada& d) {
+    // 5XY2: Armazena VX a VY (em qualquer ordem) na memória a partir de I,
+    // sem mudar I (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_5XY2);
+    int passo = d.X <= d.Y ? 1 : -1;
+    int n = (d.X <= d.Y ? d.Y - d.X : d.X - d.Y) + 1;
+    for (int i = 0; i < n; i++) vm.RAM[C8_Endereco(vm, vm.I + i)] = vm.V[d.X + i * passo];
+    C8_MarcarPaginas(vm, vm.I, n);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_5XY3(VM& vm, const OpDecodificada& d) {
+    // 5XY3: Lê VX a VY da memória a partir de I, sem mudar I (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_5XY3);
+    int passo = d.X <= d.Y ? 1 : -1;
+    int n = (d.X <= d.Y ? d.Y - d.X : d.X - d.Y) + 1;
+    for (int i = 0; i < n; i++) vm.V[d.X + i * passo] = vm.RAM[C8_Endereco(vm, vm.I + i)];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_6XNN(VM& vm, const OpDecodificada& d) {
+    // 6XNN: Define VX = NN
+    vm.V[d.X] = d.NN;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_7XNN(VM& vm, const OpDecodificada& d) {
+    // 7XNN: Adiciona NN a VX (VX = VX + NN)
+    vm.V[d.X] += d.NN;
+    return VM_OK;
+}
+
+// Instruções lógicas e matemáticas (8XYN)
+
+template<class Q> inline VM_Status op_8XY0(VM& vm, const OpDecodificada& d) {
+    // 8XY0: VX = VY
+    vm.V[d.X] = vm.V[d.Y];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY1(VM& vm, const OpDecodificada& d) {
+    // 8XY1: VX = VX | VY (no VIP, VF = 0)
+    vm.V[d.X] |= vm.V[d.Y];
+    if (Q::reset_vf) vm.V[0xF] = 0;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY2(VM& vm, const OpDecodificada& d) {
+    // 8XY2: VX = VX & VY (no VIP, VF = 0)
+    vm.V[d.X] &= vm.V[d.Y];
+    if (Q::reset_vf) vm.V[0xF] = 0;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY3(VM& vm, const OpDecodificada& d) {
+    // 8XY3: VX = VX ^ VY (no VIP, VF = 0)
+    vm.V[d.X] ^= vm.V[d.Y];
+    if (Q::reset_vf) vm.V[0xF] = 0;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY4(VM& vm, const OpDecodificada& d) {
+    // 8XY4: VX = VX + VY, VF = carry
+    uint16_t soma = vm.V[d.X] + vm.V[d.Y];
+    vm.V[0xF] = soma > 0xFF; // Define VF (carry)
+    vm.V[d.X] = soma & 0xFF;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY5(VM& vm, const OpDecodificada& d) {
+    // 8XY5: VX = VX - VY, VF = NOT borrow
+    vm.V[0xF] = vm.V[d.X] > vm.V[d.Y]; // Define VF
+    vm.V[d.X] -= vm.V[d.Y];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY6(VM& vm, const OpDecodificada& d) {
+    // 8XY6: VX = VX >> 1 (VY >> 1 no VIP/moderno), VF = bit menos significativo
+    const uint8_t s = Q::desloca_vy ? d.Y : d.X;
+    vm.V[0xF] = vm.V[s] & 0x1;
+    vm.V[d.X] = vm.V[s] >> 1;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XY7(VM& vm, const OpDecodificada& d) {
+    // 8XY7: VX = VY - VX, VF = NOT borrow
+    vm.V[0xF] = vm.V[d.Y] > vm.V[d.X]; // Define VF
+    vm.V[d.X] = vm.V[d.Y] - vm.V[d.X];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_8XYE(VM& vm, const OpDecodificada& d) {
+    // 8XYE: VX = VX << 1 (VY << 1 no VIP/moderno), VF = bit mais significativo
+    const uint8_t s = Q::desloca_vy ? d.Y : d.X;
+    vm.V[0xF] = (vm.V[s] & 0x80) >> 7;
+    vm.V[d.X] = vm.V[s] << 1;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_9XY0(VM& vm, const OpDecodificada& d) {
+    // 9XY0: Pula a próxima instrução se VX != VY
+    if (vm.V[d.X] != vm.V[d.Y]) C8_Pular<Q>(vm);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_ANNN(VM& vm, const OpDecodificada& d) {
+    // ANNN: Define I = NNN
+    vm.I = d.NNN;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_BNNN(VM& vm, const OpDecodificada& d) {
+    // BNNN: Pula para NNN + V0 (CHIP-48/SUPER-CHIP: XNN + VX)
+    vm.PC = d.NNN + vm.V[Q::salto_vx ? d.X : 0];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_CXNN(VM& vm, const OpDecodificada& d) {
+    // CXNN: Define VX = random_byte & NN
+    vm.V[d.X] = C8_Aleatorio(vm) & d.NN;
+    return VM_OK;
+}
+
+// Desenha 'linhas' linhas de um sprite (8 ou 16 pixels de largura, já
+// alinhadas no topo de uma palavra) em um plano. Cada linha do sprite vira
+// uma palavra (lores) ou duas (hires) alinhadas em x. Com recorte, o que
+// passa da borda direita/de baixo cai fora; sem, aparece do outro lado. A
+// colisão e o desenho são um AND e um XOR por palavra.
+template<class Q>
+inline uint64_t C8_DesenharPlano(VM& vm, uint64_t* tela, const uint64_t* sprite, int linhas,
+                                 int x, int y) {
+    uint64_t colisao = 0;
+    if (!vm.hires) {
+        for (int i = 0; i < linhas && (!Q::recorte || y + i < 32); i++) {
+            int ly = (y + i) % 32;
+            uint64_t linha = sprite[i] >> x;
+            if (!Q::recorte && x) linha |= sprite[i] << (64 - x);
+            colisao |= tela[ly] & linha;
+            tela[ly] ^= linha;
+            vm.linhas_alteradas |= (uint64_t)(linha != 0) << ly;
+        }
+    } else {
+        for (int i = 0; i < linhas && (!Q::recorte || y + i < 64); i++) {
+            int ly = (y + i) % 64;
+            uint64_t* t = tela + 2 * ly;
+            uint64_t esq = x < 64 ? sprite[i] >> x : 0;
+            uint64_t dir = x < 64 ? (x ? sprite[i] << (64 - x) : 0) : sprite[i] >> (x - 64);
+            if (!Q::recorte && x > 64) esq |= sprite[i] << (128 - x);
+            colisao |= (t[0] & esq) | (t[1] & dir);
+            t[0] ^= esq;
+            t[1] ^= dir;
+            vm.linhas_alteradas |= (uint64_t)((esq | dir) != 0) << ly;
+        }
+    }
+    return colisao;
+}
+
+template<class Q> inline VM_Status op_DXYN(VM& vm, const OpDecodificada& d) {
+    // DXYN: Desenha sprite 8xN em (VX, VY). DXY0 desenha um sprite 16x16
+    // (SUPER-CHIP; no CHIP-8 não desenha nada). Com os dois planos
+    // selecionados (XO-CHIP), os dados do segundo plano vêm logo depois dos
+    // do primeiro.
+    uint8_t x_pos = vm.V[d.X] % vm.VM_Largura();
+    uint8_t y_pos = vm.V[d.Y] % vm.VM_Altura();
+    int linhas = d.N ? d.N : Q::extensao >= VM_EXT_SCHIP ? 16 : 0;
+    uint32_t endereco = vm.I;
+    uint64_t sprite[16];
+    uint64_t colisao = 0;
+
+    for (int p = 0; p < VM_PLANOS; p++) {
+        if (!(vm.planos & (1 << p))) continue;
+        if (d.N) {
+            for (int i = 0; i < linhas; i++) sprite[i] = (uint64_t)vm.RAM[C8_Endereco(vm, endereco + i)] << 56;
+        } else {
+            for (int i = 0; i < linhas; i++) {
+                sprite[i] = (uint64_t)((vm.RAM[C8_Endereco(vm, endereco + 2 * i)] << 8) |
+                                       vm.RAM[C8_Endereco(vm, endereco + 2 * i + 1)]) << 48;
+            }
+        }
+        endereco += d.N ? linhas : 2 * linhas;
+        colisao |= C8_DesenharPlano<Q>(vm, vm.DISPLAY[p], sprite, linhas, x_pos, y_pos);
+    }
+    vm.V[0xF] = colisao != 0; // Flag de colisão
+    return VM_OK;
+}
+
+// Instruções de teclado
+
+template<class Q> inline VM_Status op_EX9E(VM& vm, const OpDecodificada& d) {
+    // EX9E: Pula a próxima instrução se a tecla em VX estiver pressionada
+    if (vm.V[d.X] < CHIP8_KEYS && vm.KEY[vm.V[d.X]] == 1) C8_Pular<Q>(vm);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_EXA1(VM& vm, const OpDecodificada& d) {
+    // EXA1: Pula a próxima instrução se a tecla em VX NÃO estiver pressionada
+    if (vm.V[d.X] < CHIP8_KEYS && vm.KEY[vm.V[d.X]] == 0) C8_Pular<Q>(vm);
+    return VM_OK;
+}
+
+// Funções diversas (FXNN)
+
+template<class Q> inline VM_Status op_F000(VM& vm, const OpDecodificada&) {
+    // F000 NNNN: I = NNNN, o endereço de 16 bits na palavra seguinte (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_F000);
+    vm.I = (vm.RAM[C8_Endereco(vm, vm.PC)] << 8) | vm.RAM[C8_Endereco(vm, vm.PC + 1)];
+    vm.PC += 2;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FN01(VM& vm, const OpDecodificada& d) {
+    // FN01: Seleciona os planos da tela usados por DXYN/00E0/scroll (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_FN01);
+    vm.planos = d.X & ((1 << VM_PLANOS) - 1);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_F002(VM& vm, const OpDecodificada&) {
+    // F002: Carrega o padrão de áudio de 16 bytes a partir de I (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_F002);
+    for (int i = 0; i < 16; i++) vm.padrao_som[i] = vm.RAM[C8_Endereco(vm, vm.I + i)];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX07(VM& vm, const OpDecodificada& d) {
+    // FX07: VX = delay_timer
+    vm.V[d.X] = vm.delay_timer;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX0A(VM& vm, const OpDecodificada& d) {
+    // FX0A: Aguarda pressionar tecla, armazena em VX
+    for (int i = 0; i < CHIP8_KEYS; ++i) {
+        if (vm.KEY[i] == 1) {
+            vm.V[d.X] = i;
+            return VM_OK;
+        }
+    }
+    // Se nenhuma tecla foi pressionada, repete esta instrução
+    vm.PC -= 2;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX15(VM& vm, const OpDecodificada& d) {
+    // FX15: delay_timer = VX
+    vm.delay_timer = vm.V[d.X];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX18(VM& vm, const OpDecodificada& d) {
+    // FX18: sound_timer = VX
+    vm.sound_timer = vm.V[d.X];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX1E(VM& vm, const OpDecodificada& d) {
+    // FX1E: I = I + VX
+    vm.I += vm.V[d.X];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX29(VM& vm, const OpDecodificada& d) {
+    // FX29: I = endereço do sprite para o dígito em VX (cada sprite tem 5 bytes)
+    vm.I = vm.V[d.X] * 5;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX30(VM& vm, const OpDecodificada& d) {
+    // FX30: I = endereço do dígito grande (8x10) em VX
+    C8_EXIGIR_EXTENSAO(OP_FX30);
+    vm.I = VM_ENDERECO_FONTE_GRANDE + (vm.V[d.X] & 0xF) * 10;
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX3A(VM& vm, const OpDecodificada& d) {
+    // FX3A: Altura do padrão de áudio = VX (XO-CHIP)
+    C8_EXIGIR_EXTENSAO(OP_FX3A);
+    vm.tom_som = vm.V[d.X];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX33(VM& vm, const OpDecodificada& d) {
+    // FX33: Armazena BCD de VX em I, I+1, I+2
+    vm.RAM[C8_Endereco(vm, vm.I)]     = vm.V[d.X] / 100;
+    vm.RAM[C8_Endereco(vm, vm.I + 1)] = (vm.V[d.X] / 10) % 10;
+    vm.RAM[C8_Endereco(vm, vm.I + 2)] = vm.V[d.X] % 10;
+    C8_MarcarPaginas(vm, vm.I, 3);
+    return VM_OK;
+}
+
+// I depois de FX55/FX65, conforme o perfil
+template<class Q> inline void C8_AvancarI(VM& vm, const OpDecodificada& d) {
+    if (Q::incremento_i == C8_I_MAIS_X1) vm.I += d.X + 1;
+    else if (Q::incremento_i == C8_I_MAIS_X) vm.I += d.X;
+}
+
+template<class Q> inline VM_Status op_FX55(VM& vm, const OpDecodificada& d) {
+    // FX55: Armazena V0 a VX na memória a partir de I
+    for (int i = 0; i <= d.X; i++) vm.RAM[C8_Endereco(vm, vm.I + i)] = vm.V[i];
+    C8_MarcarPaginas(vm, vm.I, d.X + 1);
+    C8_AvancarI<Q>(vm, d);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX65(VM& vm, const OpDecodificada& d) {
+    // FX65: Lê V0 a VX da memória a partir de I
+    for (int i = 0; i <= d.X; i++) vm.V[i] = vm.RAM[C8_Endereco(vm, vm.I + i)];
+    C8_AvancarI<Q>(vm, d);
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX75(VM& vm, const OpDecodificada& d) {
+    // FX75: Guarda V0 a VX nas flags RPL
+    C8_EXIGIR_EXTENSAO(OP_FX75);
+    for (int i = 0; i <= d.X; i++) vm.RPL[i] = vm.V[i];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_FX85(VM& vm, const OpDecodificada& d) {
+    // FX85: Lê V0 a VX das flags RPL
+    C8_EXIGIR_EXTENSAO(OP_FX85);
+    for (int i = 0; i <= d.X; i++) vm.V[i] = vm.RPL[i];
+    return VM_OK;
+}
+
+template<class Q> inline VM_Status op_INVALIDA(VM& vm, const OpDecodificada&) {
+    vm.PC -= 2;
+    return VM_ERRO_OPCODE_INVALIDO;
+}
+
+// Faixa da RAM que uma operação C8_ESCRITA vai escrever. Deve ser chamada
+// antes de executar a operação (usa o valor atual de I). Se a escrita dá a
+// volta no fim da memória (C8_Endereco), a faixa é a RAM inteira: é raro e
+// assim quem usa a faixa não precisa tratar duas partes.
+inline void C8_FaixaEscrita(const VM& vm, const OpDecodificada& d, uint32_t* inicio, uint32_t* tam) {
+    *inicio = C8_Endereco(vm, vm.I);
+    if (d.op == OP_FX33)      *tam = 3;
+    else if (d.op == OP_5XY2) *tam = (d.X <= d.Y ? d.Y - d.X : d.X - d.Y) + 1;
+    else                      *tam = d.X + 1;
+    if (*inicio + *tam > vm.tam_ram) {
+        *inicio = 0;
+        *tam = vm.tam_ram;
+    }
+}
+
+#endif
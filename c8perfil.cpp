@@ -0,0 +1,270 @@
+#include "c8perfil.h"
+#include "c8ops.h"
+#include <stddef.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+#include <map>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Relógio de alta resolução e baixo custo (uma leitura por instrução)
+static inline uint64_t perfil_ticks() {
+#if defined(__x86_64__) || defined(__i386__)
+    return __rdtsc();
+#else
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+        std::chrono::steady_clock::now().time_since_epoch()).count();
+#endif
+}
+
+#define C8_NOME_OP(NOME, TIPO) #NOME,
+static const char* const nomes_op[C8_NUM_OPS] = { C8_OPS(C8_NOME_OP) "?" };
+#undef C8_NOME_OP
+
+MotorPerfil::MotorPerfil() {
+    memset(this->por_op, 0, sizeof(this->por_op));
+    memset(this->por_pc, 0, sizeof(this->por_pc));
+    NoChamada raiz = {0, 0, 0, {0, 0}};
+    this->nos.push_back(raiz);
+    this->no_atual = 0;
+    this->vm_atual = NULL;
+    this->ticks_total = 0;
+    this->segundos_total = 0;
+}
+
+void MotorPerfil::InvalidarTudo() {
+    this->no_atual = 0;
+}
+
+void MotorPerfil::Entrar(uint16_t rotina) {
+    uint64_t chave = ((uint64_t)this->no_atual << 16) | rotina;
+    std::unordered_map<uint64_t, uint32_t>::iterator it = this->filhos.find(chave);
+    if (it == this->filhos.end()) {
+        NoChamada no = {this->no_atual, rotina, 0, {0, 0}};
+        this->nos.push_back(no);
+        it = this->filhos.insert(std::make_pair(chave, (uint32_t)(this->nos.size() - 1))).first;
+    }
+    this->no_atual = it->second;
+    this->nos[this->no_atual].chamadas++;
+}
+
+VM_Status MotorPerfil::Executar(VM& vm, uint64_t ciclos) {
+    if (&vm != this->vm_atual) {
+        this->no_atual = 0;
+        this->vm_atual = &vm;
+    }
+    C8_DESPACHAR_QUIRKS(vm.quirks, this->ExecutarCom<Q>(vm, ciclos));
+}
+
+template<class Q>
+VM_Status MotorPerfil::ExecutarCom(VM& vm, uint64_t ciclos) {
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    uint64_t inicio = perfil_ticks();
+    uint64_t anterior = inicio;
+    VM_Status st = VM_OK;
+
+    for (uint64_t c = 0; c < ciclos; c++) {
+        vm.PC &= vm.tam_ram - 1;
+        uint16_t pc = vm.PC;
+        uint16_t inst = (vm.RAM[pc] << 8) | vm.RAM[C8_Endereco(vm, pc + 1)];
+        #ifdef DEBUG
+        if (vm.rastro_ativo) {
+            VM_EntradaRastro& r = vm.rastro[vm.rastro_pos++ % VM_TAM_RASTRO];
+            r.pc = pc;
+            r.inst = inst;
+        }
+        #endif
+        OpDecodificada d = C8_Decodificar(inst);
+        vm.PC += 2;
+
+        #define C8_CASO_OP(NOME, TIPO) case OP_##NOME: st = op_##NOME<Q>(vm, d); break;
+        switch (d.op) {
+            C8_OPS(C8_CASO_OP)
+            default: st = VM_ERRO_OPCODE_INVALIDO; break;
+        }
+        #undef C8_CASO_OP
+
+        // A instrução (inclusive o 2NNN/00EE) conta para a rotina em que estava
+        uint64_t agora = perfil_ticks();
+        uint64_t dt = agora - anterior;
+        anterior = agora;
+        this->por_op[d.op].execucoes++;
+        this->por_op[d.op].ticks += dt;
+        this->por_pc[pc].execucoes++;
+        this->por_pc[pc].ticks += dt;
+        this->nos[this->no_atual].proprio.execucoes++;
+        this->nos[this->no_atual].proprio.ticks += dt;
+
+        if (st != VM_OK) break;
+        if (d.op == OP_2NNN) {
+            this->Entrar(d.NNN);
+        } else if (d.op == OP_00EE) {
+            // Com a pilha da VM vazia a ROM voltou ao nível de cima, mesmo
+            // que a pilha paralela discorde (ex: a ROM mexeu no SP)
+            this->no_atual = vm.SP == 0 ? 0 : this->nos[this->no_atual].pai;
+        }
+    }
+
+    this->ticks_total += anterior - inicio;
+    this->segundos_total += std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    return st;
+}
+
+double MotorPerfil::NsPorTick() const {
+    return this->ticks_total ? this->segundos_total * 1e9 / this->ticks_total : 0.0;
+}
+
+static std::string nome_rotina(uint16_t rotina) {
+    char nome[16];
+    snprintf(nome, sizeof(nome), "sub_%03X", rotina);
+    return nome;
+}
+
+std::string MotorPerfil::Pilha(uint32_t no) const {
+    std::vector<uint32_t> caminho;
+    for (uint32_t n = no; n != 0; n = this->nos[n].pai) caminho.push_back(n);
+
+    std::string pilha = "main";
+    for (size_t i = caminho.size(); i-- > 0;) pilha += ";" + nome_rotina(this->nos[caminho[i]].rotina);
+    return pilha;
+}
+
+static bool pc_mais_caro(const std::pair<uint64_t, int>& a, const std::pair<uint64_t, int>& b) {
+    return a.first > b.first;
+}
+
+void MotorPerfil::ImprimirRelatorio(FILE* saida, int max_pcs) const {
+    double ns = this->NsPorTick();
+    uint64_t total = 0;
+    for (int op = 0; op < C8_NUM_OPS; op++) total += this->por_op[op].execucoes;
+    double total_ms = this->ticks_total * ns / 1e6;
+
+    fprintf(saida, "Perfil: %llu instruções em %.3f ms (%.2f ns por instrução, com a medição)\n\n",
+            (unsigned long long)total, total_ms, total ? this->ticks_total * ns / total : 0.0);
+
+    // Grupos (1º dígito do nome da operação) e suas operações
+    fprintf(saida, "%-10s %14s %7s %12s %7s %10s\n", "Operação", "Execuções", "%", "Tempo (ms)", "%", "ns/exec");
+    for (int g = 0; g < 16; g++) {
+        char digito = "0123456789ABCDEF"[g];
+        Contador soma = {0, 0};
+        for (int op = 0; op < OP_INVALIDA; op++) {
+            if (nomes_op[op][0] != digito) continue;
+            soma.execucoes += this->por_op[op].execucoes;
+            soma.ticks += this->por_op[op].ticks;
+        }
+        if (soma.execucoes == 0) continue;
+
+        fprintf(saida, "%cxxx       %14llu %6.2f%% %12.3f %6.2f%% %10.2f\n", digito,
+                (unsigned long long)soma.execucoes, 100.0 * soma.execucoes / total, soma.ticks * ns / 1e6,
+                this->ticks_total ? 100.0 * soma.ticks / this->ticks_total : 0.0, soma.ticks * ns / soma.execucoes);
+        for (int op = 0; op < OP_INVALIDA; op++) {
+            const Contador& c = this->por_op[op];
+            if (nomes_op[op][0] != digito || c.execucoes == 0) continue;
+            fprintf(saida, "  %-8s %14llu %6.2f%% %12.3f %6.2f%% %10.2f\n", nomes_op[op],
+                    (unsigned long long)c.execucoes, 100.0 * c.execucoes / total, c.ticks * ns / 1e6,
+                    this->ticks_total ? 100.0 * c.ticks / this->ticks_total : 0.0, c.ticks * ns / c.execucoes);
+        }
+    }
+    if (this->por_op[OP_INVALIDA].execucoes) {
+        fprintf(saida, "inválidas  %14llu\n", (unsigned long long)this->por_op[OP_INVALIDA].execucoes);
+    }
+
+    // PCs que mais consumiram tempo
+    std::vector<std::pair<uint64_t, int> > pcs;
+    for (int pc = 0; pc < VM_TAM_RAM; pc++) {
+        if (this->por_pc[pc].execucoes) pcs.push_back(std::make_pair(this->por_pc[pc].ticks, pc));
+    }
+    std::sort(pcs.begin(), pcs.end(), pc_mais_caro);
+    fprintf(saida, "\n%-10s %14s %7s %12s %7s\n", "PC", "Execuções", "%", "Tempo (ms)", "%");
+    for (size_t i = 0; i < pcs.size() && (int)i < max_pcs; i++) {
+        const Contador& c = this->por_pc[pcs[i].second];
+        fprintf(saida, "0x%03X      %14llu %6.2f%% %12.3f %6.2f%%\n", pcs[i].second,
+                (unsigned long long)c.execucoes, 100.0 * c.execucoes / total, c.ticks * ns / 1e6,
+                this->ticks_total ? 100.0 * c.ticks / this->ticks_total : 0.0);
+    }
+
+    // Arestas do grafo de chamadas (quem chamou -> rotina) e tempo por
+    // rotina: próprio e incluindo o que ela chamou (sem contar duas vezes
+    // uma rotina recursiva)
+    std::map<std::pair<int, int>, uint64_t> arestas;
+    std::map<int, Contador> proprio, inclusivo;
+    for (size_t n = 1; n < this->nos.size(); n++) {
+        const NoChamada& no = this->nos[n];
+        int chamador = no.pai == 0 ? -1 : this->nos[no.pai].rotina;
+        arestas[std::make_pair(chamador, (int)no.rotina)] += no.chamadas;
+    }
+    for (size_t n = 0; n < this->nos.size(); n++) {
+        const NoChamada& no = this->nos[n];
+        int rotina = n == 0 ? -1 : no.rotina;
+        proprio[rotina].execucoes += no.proprio.execucoes;
+        proprio[rotina].ticks += no.proprio.ticks;
+
+        std::vector<int> vistas;
+        for (uint32_t m = (uint32_t)n;; m = this->nos[m].pai) {
+            int r = m == 0 ? -1 : this->nos[m].rotina;
+            if (std::find(vistas.begin(), vistas.end(), r) == vistas.end()) {
+                vistas.push_back(r);
+                inclusivo[r].execucoes += no.proprio.execucoes;
+                inclusivo[r].ticks += no.proprio.ticks;
+            }
+            if (m == 0) break;
+        }
+    }
+
+    fprintf(saida, "\nChamadas (2NNN):\n");
+    for (std::map<std::pair<int, int>, uint64_t>::const_iterator it = arestas.begin(); it != arestas.end(); ++it) {
+        std::string de = it->first.first < 0 ? "main" : nome_rotina(it->first.first);
+        fprintf(saida, "  %-8s -> %-8s %14llu\n", de.c_str(), nome_rotina(it->first.second).c_str(),
+                (unsigned long long)it->second);
+    }
+
+    fprintf(saida, "\n%-10s %14s %12s %14s %12s\n", "Rotina", "Instr. próprias", "Próprio (ms)",
+            "Instr. total", "Total (ms)");
+    for (std::map<int, Contador>::const_iterator it = inclusivo.begin(); it != inclusivo.end(); ++it) {
+        std::string nome = it->first < 0 ? "main" : nome_rotina(it->first);
+        const Contador& p = proprio[it->first];
+        fprintf(saida, "%-10s %14llu %12.3f %14llu %12.3f\n", nome.c_str(),
+                (unsigned long long)p.execucoes, p.ticks * ns / 1e6,
+                (unsigned long long)it->second.execucoes, it->second.ticks * ns / 1e6);
+    }
+}
+
+bool MotorPerfil::SalvarPilhas(const char* caminho, std::string* erro) const {
+    FILE* arq = fopen(caminho, "w");
+    if (!arq) {
+        if (erro) *erro = "não foi possível criar o arquivo";
+        return false;
+    }
+    double ns = this->NsPorTick();
+    for (size_t n = 0; n < this->nos.size(); n++) {
+        const NoChamada& no = this->nos[n];
+        if (no.proprio.execucoes == 0) continue;
+        fprintf(arq, "%s %llu\n", this->Pilha((uint32_t)n).c_str(),
+                (unsigned long long)(no.proprio.ticks * ns + 0.5));
+    }
+    bool ok = !ferror(arq);
+    if (fclose(arq) != 0) ok = false;
+    if (!ok && erro) *erro = "erro ao gravar o arquivo";
+    return ok;
+}
+
+bool MotorPerfil::Salvar(const char* prefixo, std::string* erro) const {
+    std::string relatorio = std::string(prefixo) + ".txt";
+    FILE* arq = fopen(relatorio.c_str(), "w");
+    if (!arq) {
+        if (erro) *erro = "não foi possível criar '" + relatorio + "'";
+        return false;
+    }
+    this->ImprimirRelatorio(arq, PERFIL_MAX_PCS);
+    bool ok = !ferror(arq);
+    if (fclose(arq) != 0) ok = false;
+    if (!ok) {
+        if (erro) *erro = "erro ao gravar '" + relatorio + "'";
+        return false;
+    }
+    return this->SalvarPilhas((std::string(prefixo) + ".folded").c_str(), erro);
+}
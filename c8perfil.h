@@ -0,0 +1,80 @@
+#ifndef C8PERFIL_H
+#define C8PERFIL_H
+
+#include <stdint.h>
+#include <stdio.h>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "c8motor.h"
+#include "c8decod.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Motor de perfil: executa como o interpretador (mesmo resultado), uma
+// instrução por vez, e conta execuções e tempo do host por operação e por
+// PC. As chamadas 2NNN/00EE são acompanhadas em uma pilha paralela, que dá
+// o grafo de chamadas e o tempo de cada sub-rotina da ROM.
+//
+// O perfil é só este motor: quando ele não é o escolhido (--perfil), os
+// outros motores não pagam nada. O tempo é medido com o contador de ciclos
+// da CPU (rdtsc) quando existe, ou com o steady_clock, e convertido para
+// nanossegundos pelo tempo total medido; inclui o custo da própria medição.
+
+// Quantos PCs entram no relatório salvo por MotorPerfil::Salvar
+#define PERFIL_MAX_PCS 32
+
+class MotorPerfil : public Motor {
+public:
+    MotorPerfil();
+
+    VM_Status Executar(VM& vm, uint64_t ciclos);
+
+    // O estado da VM mudou por fora (estado carregado, volta no tempo): a
+    // pilha de chamadas recomeça na raiz. As contagens são mantidas.
+    void InvalidarTudo();
+
+    // Relatório em texto: operações por grupo, os 'max_pcs' PCs mais caros,
+    // arestas do grafo de chamadas e tempo por sub-rotina
+    void ImprimirRelatorio(FILE* saida, int max_pcs) const;
+
+    // Pilhas no formato "folded" (flamegraph.pl, speedscope, inferno): uma
+    // linha "main;sub_2A4;sub_310 <ns>" por pilha, com o tempo próprio
+    bool SalvarPilhas(const char* caminho, std::string* erro) const;
+
+    // Grava o relatório em "<prefixo>.txt" e as pilhas em "<prefixo>.folded"
+    bool Salvar(const char* prefixo, std::string* erro) const;
+
+private:
+    struct Contador {
+        uint64_t execucoes;
+        uint64_t ticks;
+    };
+
+    // Nó da árvore de chamadas: uma sub-rotina chamada a partir de uma pilha
+    struct NoChamada {
+        uint32_t pai;         // Nó 0 = raiz (código fora de sub-rotina)
+        uint16_t rotina;      // Endereço chamado pelo 2NNN
+        uint64_t chamadas;
+        Contador proprio;     // Instruções executadas dentro da rotina
+    };
+
+    Contador por_op[C8_NUM_OPS];
+    Contador por_pc[VM_TAM_RAM];
+    std::vector<NoChamada> nos;
+    std::unordered_map<uint64_t, uint32_t> filhos; // (pai << 16) | rotina -> nó
+    uint32_t no_atual;
+    const VM* vm_atual;
+
+    uint64_t ticks_total;
+    double segundos_total;
+
+    // Laço de medição especializado para um perfil de quirks (veja C8_Quirks)
+    template<class Q> VM_Status ExecutarCom(VM& vm, uint64_t ciclos);
+
+    void Entrar(uint16_t rotina);
+    double NsPorTick() const;
+    std::string Pilha(uint32_t no) const;
+};
+
+#endif
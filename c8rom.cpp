@@ -0,0 +1,124 @@
+#include "c8rom.h"
+#include "c8vm.h"
+#include <stdio.h>
+#include <string.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <tuple>
+#include <unordered_map>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Identifica um arquivo sem abrir: se nada disso mudou, o conteúdo é o mesmo
+typedef std::tuple<dev_t, ino_t, off_t, time_t, long, uint16_t> ChaveArquivo;
+
+struct CacheROM {
+    std::mutex trava;
+    std::deque<ImagemROM> imagens;  // deque: push_back não move as imagens
+    std::unordered_multimap<uint64_t, const ImagemROM*> por_conteudo;
+    std::map<ChaveArquivo, const ImagemROM*> por_arquivo;
+};
+
+static CacheROM& rom_cache() {
+    static CacheROM cache;
+    return cache;
+}
+
+static bool rom_erro(std::string* erro, const std::string& msg) {
+    if (erro) *erro = msg;
+    return false;
+}
+
+// Mapeia o arquivo só para leitura. Com tam 0 não há mapa (*dados = NULL).
+static bool rom_mapear(const char* caminho, uint16_t pc_inicial, struct stat* st,
+                       const uint8_t** dados, size_t* tam, std::string* erro) {
+    int fd = open(caminho, O_RDONLY);
+    if (fd < 0) return rom_erro(erro, std::string("não foi possível abrir a ROM: ") + strerror(errno));
+
+    if (fstat(fd, st) != 0 || !S_ISREG(st->st_mode)) {
+        close(fd);
+        return rom_erro(erro, "a ROM não é um arquivo comum");
+    }
+
+    // Verifica se a ROM cabe na memória a partir do endereço inicial
+    *tam = (size_t)st->st_size;
+    if (pc_inicial + *tam > VM_TAM_RAM) {
+        close(fd);
+        return rom_erro(erro, "a ROM deve caber em 64KB");
+    }
+
+    *dados = NULL;
+    if (*tam > 0) {
+        void* mapa = mmap(NULL, *tam, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (mapa == MAP_FAILED) {
+            close(fd);
+            return rom_erro(erro, std::string("erro ao ler a ROM: ") + strerror(errno));
+        }
+        *dados = (const uint8_t*)mapa;
+    }
+    close(fd);
+    return true;
+}
+
+static ChaveArquivo rom_chave(const struct stat& st, uint16_t pc_inicial) {
+    return ChaveArquivo(st.st_dev, st.st_ino, st.st_size, st.st_mtim.tv_sec, st.st_mtim.tv_nsec, pc_inicial);
+}
+
+const ImagemROM* ROM_Carregar(const char* caminho, uint16_t pc_inicial, std::string* erro) {
+    CacheROM& cache = rom_cache();
+
+    // Mesmo arquivo de antes: basta um stat
+    struct stat st;
+    if (stat(caminho, &st) == 0) {
+        std::lock_guard<std::mutex> g(cache.trava);
+        std::map<ChaveArquivo, const ImagemROM*>::iterator it = cache.por_arquivo.find(rom_chave(st, pc_inicial));
+        if (it != cache.por_arquivo.end()) return it->second;
+    }
+
+    const uint8_t* dados;
+    size_t tam;
+    if (!rom_mapear(caminho, pc_inicial, &st, &dados, &tam, erro)) return NULL;
+    uint64_t hash = VM_Fnv1a(VM_FNV_INICIO, dados, tam);
+
+    std::lock_guard<std::mutex> g(cache.trava);
+
+    // Mesmo conteúdo de outro arquivo
+    const ImagemROM* img = NULL;
+    typedef std::unordered_multimap<uint64_t, const ImagemROM*>::iterator Iter;
+    std::pair<Iter, Iter> iguais = cache.por_conteudo.equal_range(hash);
+    for (Iter it = iguais.first; it != iguais.second && img == NULL; ++it) {
+        const ImagemROM* c = it->second;
+        if (c->pc_inicial == pc_inicial && c->tamanho == tam &&
+            (tam == 0 || memcmp(c->RAM.data() + pc_inicial, dados, tam) == 0)) {
+            img = c;
+        }
+    }
+
+    if (img == NULL) {
+        cache.imagens.emplace_back();
+        ImagemROM& nova = cache.imagens.back();
+        // ROMs maiores que 4KB (XO-CHIP) ganham os 64KB, o resto zerado
+        nova.tam_ram = pc_inicial + tam > VM_TAM_RAM_CHIP8 ? VM_TAM_RAM : VM_TAM_RAM_CHIP8;
+        // A imagem parte da RAM de uma VM recém-inicializada (fonte no lugar)
+        nova.RAM.assign(nova.tam_ram, 0);
+        memcpy(nova.RAM.data(), VM_RAMInicial(), VM_TAM_RAM_CHIP8);
+        if (tam > 0) memcpy(nova.RAM.data() + pc_inicial, dados, tam);
+        nova.pc_inicial = pc_inicial;
+        nova.tamanho = (uint32_t)tam;
+        nova.hash = hash;
+        cache.por_conteudo.insert(std::make_pair(hash, (const ImagemROM*)&nova));
+        img = &nova;
+
+        fprintf(stderr, "ROM '%s' carregada (%zu bytes) em 0x%03X\n", caminho, tam, pc_inicial);
+    }
+    cache.por_arquivo[rom_chave(st, pc_inicial)] = img;
+
+    if (dados) munmap((void*)dados, tam);
+    return img;
+}
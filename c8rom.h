@@ -0,0 +1,34 @@
+#ifndef C8ROM_H
+#define C8ROM_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "c8vm.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Cache de ROMs do processo. Cada arquivo é lido uma vez (mmap) e vira uma
+// ImagemROM: a RAM inicial de uma VM (fonte + ROM no endereço de carga),
+// pronta para ser copiada inteira com VM::VM_Inicializar(pc, ram, tam_ram). As
+// imagens são indexadas pelo hash do conteúdo, então arquivos diferentes
+// com a mesma ROM dividem uma imagem, e o mesmo arquivo (mesmo inode,
+// tamanho e data de modificação) nem é lido de novo.
+//
+// As imagens nunca são liberadas nem alteradas: o ponteiro retornado vale
+// até o fim do processo e pode ser usado por várias threads ao mesmo tempo.
+// ROM_Carregar também pode ser chamada de várias threads.
+
+struct ImagemROM {
+    std::vector<uint8_t> RAM; // tam_ram bytes
+    uint32_t tam_ram;      // VM_TAM_RAM_CHIP8, ou VM_TAM_RAM se a ROM não couber em 4KB (só no XO-CHIP)
+    uint16_t pc_inicial;
+    uint32_t tamanho;      // Bytes da ROM
+    uint64_t hash;         // FNV-1a 64 do conteúdo da ROM
+};
+
+// Retorna NULL e preenche 'erro' (se não for NULL) se o arquivo não puder
+// ser lido ou a ROM não couber na memória (64KB) a partir de 'pc_inicial'
+const ImagemROM* ROM_Carregar(const char* caminho, uint16_t pc_inicial, std::string* erro);
+
+#endif
@@ -0,0 +1,92 @@
+#include "c8som.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Evento mais adiantado que isto em relação ao que está tocando (ex: o
+// relógio emulado voltou) realinha o tempo em vez de esperar
+#define SOM_MAX_ADIANTAMENTO_S 1
+
+SomVM::SomVM(int taxa) {
+    this->taxa = taxa;
+    this->ligado_enviado = false;
+    this->ligado = false;
+    this->fase = 0;
+    this->incremento = SOM_FREQUENCIA_TOM / taxa;
+    this->ganho = 0;
+    this->passo_rampa = 1000.0 / (SOM_MS_RAMPA * taxa);
+    this->posicao = 0;
+    this->desvio = 0;
+    this->alinhado = false;
+}
+
+void SomVM::Quadro(uint64_t quadro, bool ligado) {
+    if (ligado == this->ligado_enviado) return;
+
+    EventoSom ev;
+    ev.amostra = quadro * (uint64_t)this->taxa / 60;
+    ev.ligado = ligado ? 1 : 0;
+    // Com a fila cheia o evento se perde, mas o próximo quadro tenta de novo
+    if (this->fila.Colocar(ev)) this->ligado_enviado = ligado;
+}
+
+// Correção PolyBLEP de uma descontinuidade de -2 para +2 em t = 0 (t e dt
+// em frações de período)
+static inline double polyblep(double t, double dt) {
+    if (t < dt) {
+        t /= dt;
+        return t + t - t * t - 1.0;
+    }
+    if (t > 1.0 - dt) {
+        t = (t - 1.0) / dt;
+        return t * t + t + t + 1.0;
+    }
+    return 0.0;
+}
+
+void SomVM::Gerar(int16_t* saida, int n) {
+    for (int i = 0; i < n; i++) {
+        int64_t agora = this->posicao + i;
+
+        // Aplica os eventos cujo instante já chegou
+        EventoSom ev;
+        while (this->fila.Espiar(&ev)) {
+            int64_t alvo = (int64_t)ev.amostra + this->desvio;
+            if (!this->alinhado || alvo < agora || alvo > agora + (int64_t)SOM_MAX_ADIANTAMENTO_S * this->taxa) {
+                // Primeiro evento, atrasado ou adiantado demais: realinha
+                this->desvio = agora - (int64_t)ev.amostra;
+                this->alinhado = true;
+                alvo = agora;
+            }
+            if (alvo > agora) break;
+
+            this->fila.Tirar(&ev);
+            if (ev.ligado && !this->ligado && this->ganho == 0) this->fase = 0;
+            this->ligado = ev.ligado != 0;
+        }
+
+        if (this->ligado) {
+            this->ganho += this->passo_rampa;
+            if (this->ganho > 1.0) this->ganho = 1.0;
+        } else {
+            this->ganho -= this->passo_rampa;
+            if (this->ganho < 0.0) this->ganho = 0.0;
+        }
+
+        double amostra = 0;
+        if (this->ganho > 0) {
+            double t = this->fase;
+            double dt = this->incremento;
+            amostra = t < 0.5 ? 1.0 : -1.0;
+            amostra += polyblep(t, dt);
+            double t2 = t + 0.5;
+            if (t2 >= 1.0) t2 -= 1.0;
+            amostra -= polyblep(t2, dt);
+            amostra *= this->ganho * SOM_VOLUME;
+
+            this->fase += dt;
+            if (this->fase >= 1.0) this->fase -= 1.0;
+        }
+        saida[i] = (int16_t)amostra;
+    }
+    this->posicao += n;
+}
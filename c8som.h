@@ -0,0 +1,63 @@
+#ifndef C8SOM_H
+#define C8SOM_H
+
+#include <stdint.h>
+#include "c8fila.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Beep do CHIP-8 sem estado compartilhado entre as threads: a emulação
+// envia por uma FilaSPSC os momentos em que o som liga e desliga (em
+// amostras do tempo emulado) e a thread de áudio sintetiza a onda a partir
+// deles. Nenhuma das duas lê o sound_timer da outra.
+//
+// A onda é quadrada com PolyBLEP (as descontinuidades são suavizadas em
+// volta de cada transição, o que tira quase todo o aliasing), e cada liga/
+// desliga cai na amostra exata do seu instante, com uma rampa curta de
+// SOM_MS_RAMPA para não estalar. O tempo emulado é alinhado ao relógio da
+// placa de som pelo primeiro evento; se um evento chega atrasado (a
+// emulação travou, quadros ociosos não emulados), o alinhamento anda para
+// frente e o espaçamento entre os eventos seguintes continua exato.
+#define SOM_FREQUENCIA_TOM 440.0
+#define SOM_VOLUME 3000
+#define SOM_MS_RAMPA 2.0
+#define SOM_CAPACIDADE_FILA 256
+
+struct EventoSom {
+    uint64_t amostra;    // Instante em amostras do tempo emulado
+    uint8_t ligado;
+};
+
+class SomVM {
+public:
+    explicit SomVM(int taxa);
+
+    int Taxa() const { return this->taxa; }
+
+    // Thread da emulação: o som passa a 'ligado' no início do quadro
+    // emulado 'quadro' (de 60Hz). Só envia quando o estado muda.
+    void Quadro(uint64_t quadro, bool ligado);
+
+    // Thread de áudio: gera 'n' amostras mono
+    void Gerar(int16_t* saida, int n);
+
+private:
+    int taxa;
+
+    // Thread da emulação
+    bool ligado_enviado;
+
+    FilaSPSC<EventoSom, SOM_CAPACIDADE_FILA> fila;
+
+    // Thread de áudio
+    bool ligado;
+    double fase;          // 0..1 dentro de um período do tom
+    double incremento;    // Fração de período por amostra
+    double ganho;         // Envelope (0..1) que segue 'ligado' pela rampa
+    double passo_rampa;
+    int64_t posicao;      // Amostras já geradas
+    int64_t desvio;       // posicao = amostra do evento + desvio
+    bool alinhado;
+};
+
+#endif
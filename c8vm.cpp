@@ -1,7 +1,9 @@
 #include "c8vm.h"
+#include "c8ops.h"
+#include "c8rom.h"
 #include <stdio.h>
 #include <stdlib.h>
-#include <time.h>
+#include <string.h>
 
 const unsigned char chip8_fontset[80] =
 {
@@ -23,67 +25,142 @@ const unsigned char chip8_fontset[80] =
   0xF0, 0x80, 0xF0, 0x80, 0x80  // F
 };
 
+// Fonte grande 8x10 (FX30): 0-9 do SUPER-CHIP e A-F do XO-CHIP
+const unsigned char chip8_fontset_grande[160] =
+{
+  0xFF, 0xFF, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, // 0
+  0x18, 0x78, 0x78, 0x18, 0x18, 0x18, 0x18, 0x18, 0xFF, 0xFF, // 1
+  0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // 2
+  0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 3
+  0xC3, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0x03, 0x03, // 4
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 5
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 6
+  0xFF, 0xFF, 0x03, 0x03, 0x06, 0x0C, 0x18, 0x18, 0x18, 0x18, // 7
+  0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, // 8
+  0xFF, 0xFF, 0xC3, 0xC3, 0xFF, 0xFF, 0x03, 0x03, 0xFF, 0xFF, // 9
+  0x7E, 0xFF, 0xC3, 0xC3, 0xC3, 0xFF, 0xFF, 0xC3, 0xC3, 0xC3, // A
+  0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, 0xC3, 0xC3, 0xFC, 0xFC, // B
+  0x3C, 0xFF, 0xC3, 0xC0, 0xC0, 0xC0, 0xC0, 0xC3, 0xFF, 0x3C, // C
+  0xFC, 0xFE, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xC3, 0xFE, 0xFC, // D
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, // E
+  0xFF, 0xFF, 0xC0, 0xC0, 0xFF, 0xFF, 0xC0, 0xC0, 0xC0, 0xC0  // F
+};
+
+
+// RAM de uma VM recém-inicializada: as fontes no início, o resto zerado
+struct RAMInicial {
+    uint8_t bytes[VM_TAM_RAM_CHIP8];
+
+    RAMInicial() {
+        memset(this->bytes, 0, sizeof(this->bytes));
+        memcpy(this->bytes + VM_ENDERECO_FONTE, chip8_fontset, sizeof(chip8_fontset));
+        memcpy(this->bytes + VM_ENDERECO_FONTE_GRANDE, chip8_fontset_grande, sizeof(chip8_fontset_grande));
+    }
+};
+
+const uint8_t* VM_RAMInicial() {
+    static const RAMInicial ram; // Construída uma vez, mesmo com várias threads
+    return ram.bytes;
+}
+
+VM_Memoria::VM_Memoria() : RAM(this->ram_chip8), tam_ram(VM_TAM_RAM_CHIP8) {}
+
+VM_Memoria::VM_Memoria(const VM_Memoria& outra) : RAM(this->ram_chip8), tam_ram(VM_TAM_RAM_CHIP8) {
+    this->VM_TrocarTamRAM(outra.tam_ram);
+    memcpy(this->RAM, outra.RAM, this->tam_ram);
+}
+
+VM_Memoria& VM_Memoria::operator=(const VM_Memoria& outra) {
+    if (this != &outra) {
+        this->VM_TrocarTamRAM(outra.tam_ram);
+        memcpy(this->RAM, outra.RAM, this->tam_ram);
+    }
+    return *this;
+}
+
+void VM_Memoria::VM_TrocarTamRAM(uint32_t tam_ram) {
+    if (tam_ram > VM_TAM_RAM_CHIP8) {
+        if (!this->ram_xochip) this->ram_xochip.reset(new uint8_t[VM_TAM_RAM]);
+        this->RAM = this->ram_xochip.get();
+        this->tam_ram = VM_TAM_RAM;
+    } else {
+        this->RAM = this->ram_chip8;
+        this->tam_ram = VM_TAM_RAM_CHIP8;
+    }
+}
 
 void VM::VM_Inicializar(uint16_t pc_inicial) {
+    this->VM_Inicializar(pc_inicial, VM_RAMInicial(), VM_TAM_RAM_CHIP8);
+}
+
+void VM::VM_Inicializar(uint16_t pc_inicial, const uint8_t* ram, uint32_t tam_ram) {
     this->PC = pc_inicial;
     this->I = 0;
     this->SP = 0;
     this->delay_timer = 0;
     this->sound_timer = 0;
 
-    // Limpa registradores, display, pilha e RAM
+    // Limpa registradores, display e pilha; a RAM vem pronta em uma cópia
     for (int i = 0; i < 16; i++) this->V[i] = 0;
-    for (int i = 0; i < 64 * 32; i++) this->DISPLAY[i] = 0;
-    for (int i = 0; i < 4096; i++) this->RAM[i] = 0;
+    memset(this->DISPLAY, 0, sizeof(this->DISPLAY));
+    this->hires = 0;
+    this->planos = 1;
+    this->linhas_alteradas = ~0ULL;
+    this->VM_TrocarTamRAM(tam_ram);
+    memcpy(this->RAM, ram, tam_ram);
+    memset(this->paginas_alteradas, 0xFF, sizeof(this->paginas_alteradas));
     for (int i = 0; i < 16; i++) this->stack[i] = 0;
     for (int i = 0; i < CHIP8_KEYS; i++) this->KEY[i] = 0; 
+    memset(this->RPL, 0, sizeof(this->RPL));
+    memset(this->padrao_som, 0, sizeof(this->padrao_som));
+    this->tom_som = 64; // 4000 Hz, o padrão do XO-CHIP
+    this->quirks = VM_QUIRKS_PADRAO;
 
-    // Carrega a fonte na RAM (início da memória)
-    for (int i = 0; i < 80; i++) {
-        this->RAM[i] = chip8_fontset[i];
-    }
-    
-    // Inicializa o gerador de números aleatórios
-    srand(time(NULL));
-}
-
-void VM::VM_CarregarROM(char* arq_rom, uint16_t pc_inicial) {
-    FILE* rom = fopen(arq_rom, "rb");
-    if (!rom) {
-        perror("Arquivo ROM está vazio ou não existe");
-        exit(EXIT_FAILURE);
-    }
+    #ifdef DEBUG
+    this->rastro_ativo = false;
+    this->rastro_pos = 0;
+    for (int i = 0; i < VM_TAM_RASTRO; i++) this->rastro[i] = VM_EntradaRastro{0, 0};
+    #endif
 
-    fseek(rom, 0, SEEK_END);
-    long tam_rom_long = ftell(rom); 
-    rewind(rom);
+    this->VM_Semear(VM_SEMENTE_PADRAO);
+}
 
-    if (tam_rom_long < 0) {
-        fprintf(stderr, "Erro ao determinar o tamanho da ROM.\n");
-        fclose(rom);
-        exit(EXIT_FAILURE);
-    }
+void VM::VM_Semear(uint64_t semente) {
+    // Um passo do splitmix64 espalha sementes pequenas (0, 1, 2...) por
+    // todos os bits; o xorshift32 não pode começar em zero
+    uint64_t z = semente + 0x9E3779B97F4A7C15ULL;
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ULL;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBULL;
+    z ^= z >> 31;
+    this->rng = (uint32_t)(z >> 32);
+    if (this->rng == 0) this->rng = 0x9E3779B9;
+}
 
-    size_t tam_rom = (size_t)tam_rom_long; 
+bool VM::VM_CarregarROM(const char* arq_rom, uint16_t pc_inicial, std::string* erro) {
+    const ImagemROM* img = ROM_Carregar(arq_rom, pc_inicial, erro);
+    if (img == NULL) return false;
 
-    // Verifica se a ROM cabe na memória a partir do endereço inicial
-    if (pc_inicial + tam_rom > sizeof(this->RAM)) {
-        fprintf(stderr, "a ROM deve caber em 4KB\n");
-        fclose(rom);
-        exit(EXIT_FAILURE);
-    }
+    if (!VM_CabeNoPerfil(img->tam_ram, (VM_Quirks)this->quirks, erro)) return false;
+    memcpy(this->RAM + pc_inicial, img->RAM.data() + pc_inicial, img->tamanho);
+    memset(this->paginas_alteradas, 0xFF, sizeof(this->paginas_alteradas));
+    return true;
+}
 
-    // Lê a ROM para a RAM
-    size_t lido = fread(&this->RAM[pc_inicial], 1, tam_rom, rom);
-    
-    if (lido != tam_rom) {
-        fprintf(stderr, "Erro ao ler o arquivo ROM.\n");
-        fclose(rom);
-        exit(EXIT_FAILURE);
-    }
-    fclose(rom);
+bool VM::VM_DefinirQuirks(VM_Quirks quirks, std::string* erro) {
+    if (!VM_CabeNoPerfil(this->tam_ram, quirks, erro)) return false;
+    this->quirks = quirks;
+    this->VM_CrescerRAM(VM_TamRAMQuirks(quirks));
+    return true;
+}
 
-    printf("ROM '%s' carregada (%zu bytes) em 0x%03X\n", arq_rom, tam_rom, pc_inicial);
+void VM::VM_CrescerRAM(uint32_t tam_ram) {
+    if (tam_ram <= this->tam_ram) return;
+    const uint8_t* antiga = this->RAM;
+    uint32_t tam_antigo = this->tam_ram;
+    this->VM_TrocarTamRAM(tam_ram);
+    memcpy(this->RAM, antiga, tam_antigo);
+    memset(this->RAM + tam_antigo, 0, tam_ram - tam_antigo);
+    memset(this->paginas_alteradas, 0xFF, sizeof(this->paginas_alteradas));
 }
 
 void VM::VM_ProcessarTimers() {
@@ -97,254 +174,93 @@ void VM::VM_ProcessarInput(uint8_t key_index, bool is_down) {
     }
 }
 
-void VM::VM_ExecutarInstrucao() {
-    // Fazer o cast para 'size_t' antes de comparar com 'sizeof'
-    if ((size_t)(this->PC + 1) >= sizeof(this->RAM)) {
-        fprintf(stderr, "ERRO: PC fora dos limites da memória (4KB)\n");
-        exit(EXIT_FAILURE);
-    }
-
-    // FETCH: Busca 2 bytes da memória e junta em uma instrução
-    uint16_t inst = (this->RAM[this->PC] << 8) | this->RAM[this->PC + 1];
+// Um ciclo completo (fetch-decode-execute). Fica 'inline' para que o laço
+// de VM_ExecutarCiclos não pague uma chamada de função por instrução.
+// Em caso de falha o PC volta a apontar para a instrução que falhou.
+template<class Q>
+inline VM_Status VM::VM_Passo() {
+    // FETCH: Busca 2 bytes da memória e junta em uma instrução. O PC dá a
+    // volta no fim da memória (veja C8_Endereco), sem teste de limite.
+    uint32_t mascara = this->tam_ram - 1;
+    uint32_t pc = this->PC & mascara;
+    uint16_t inst = (this->RAM[pc] << 8) | this->RAM[(pc + 1) & mascara];
     #ifdef DEBUG
-    printf("Instrução: 0x%04X\n", inst);
+    if (this->rastro_ativo) {
+        // Só grava PC e instrução no buffer circular; nada de stdio aqui
+        VM_EntradaRastro& r = this->rastro[this->rastro_pos++ % VM_TAM_RASTRO];
+        r.pc = pc;
+        r.inst = inst;
+    }
     #endif
 
-    // DECODE: Extrai os nibbles e bytes da instrução
-    uint8_t grupo = inst >> 12;      // Os 4 bits mais altos (Ex: 0xD...)
-    uint8_t X = (inst & 0x0F00) >> 8; // O 2º nibble (Ex: ...X..)
-    uint8_t Y = (inst & 0x00F0) >> 4; // O 3º nibble (Ex: ....Y.)
-    uint8_t N = inst & 0x000F;       // Os 4 bits mais baixos (Ex: .....N)
-    uint8_t NN = inst & 0x00FF;      // Os 8 bits mais baixos (Ex: ...NN)
-    uint16_t NNN = inst & 0x0FFF;    // Os 12 bits mais baixos (Ex: .NNN)
+    // DECODE: Extrai a operação e os nibbles/bytes da instrução
+    OpDecodificada d = C8_Decodificar(inst);
 
     // Incrementa o PC ANTES de executar. Jumps/Calls irão sobrescrever isso.
-    this->PC += 2;
-
-    // EXECUTE:
-    switch (grupo) {
-        case 0:
-            if (inst == 0x00E0) {
-                // 00E0: Limpa a tela
-                for (int i = 0; i < 64 * 32; i++) this->DISPLAY[i] = 0;
-            } else if (inst == 0x00EE) {
-                // 00EE: Retorna de uma sub-rotina
-                if (this->SP == 0) {
-                    fprintf(stderr, "Stack underflow em RET!\n");
-                    exit(EXIT_FAILURE);
-                }
-                this->SP--;
-                this->PC = this->stack[this->SP];
-            } else {
-                #ifdef DEBUG
-                printf("NOP / SYS não implementado (0x%04X)\n", inst);
-                #endif
-            }
-            break;
-
-        case 1:
-            // 1NNN: Pula para o endereço NNN
-            this->PC = NNN;
-            break;
-
-        case 2:
-            // 2NNN: Chama sub-rotina em NNN
-            if (this->SP >= 16) {
-                fprintf(stderr, "Stack overflow em CALL!\n");
-                exit(EXIT_FAILURE);
-            }
-            this->stack[this->SP++] = this->PC;
-            this->PC = NNN;
-            break;
-
-        case 3:
-            // 3XNN: Pula a próxima instrução se VX == NN
-            if (this->V[X] == NN) this->PC += 2;
-            break;
-
-        case 4:
-            // 4XNN: Pula a próxima instrução se VX != NN
-            if (this->V[X] != NN) this->PC += 2;
-            break;
-
-        case 5:
-            // 5XY0: Pula a próxima instrução se VX == VY
-            if (this->V[X] == this->V[Y]) this->PC += 2;
-            break;
-
-        case 6:
-            // 6XNN: Define VX = NN
-            this->V[X] = NN;
-            break;
-
-        case 7:
-            // 7XNN: Adiciona NN a VX (VX = VX + NN)
-            this->V[X] += NN;
-            break;
-
-        case 8:
-            // Instruções lógicas e matemáticas (8XYN)
-            switch (N) {
-                case 0: // 8XY0: VX = VY
-                    this->V[X] = this->V[Y]; break;
-                case 1: // 8XY1: VX = VX | VY
-                    this->V[X] |= this->V[Y]; break;
-                case 2: // 8XY2: VX = VX & VY
-                    this->V[X] &= this->V[Y]; break;
-                case 3: // 8XY3: VX = VX ^ VY
-                    this->V[X] ^= this->V[Y]; break;
-                case 4: { // 8XY4: VX = VX + VY, VF = carry
-                    uint16_t soma = this->V[X] + this->V[Y];
-                    this->V[0xF] = soma > 0xFF; // Define VF (carry)
-                    this->V[X] = soma & 0xFF;
-                } break;
-                case 5: { // 8XY5: VX = VX - VY, VF = NOT borrow
-                    this->V[0xF] = this->V[X] > this->V[Y]; // Define VF
-                    this->V[X] -= this->V[Y];
-                } break;
-                case 6: // 8XY6: VX = VX >> 1, VF = bit menos significativo
-                    this->V[0xF] = this->V[X] & 0x1;
-                    this->V[X] >>= 1;
-                    break;
-                case 7: { // 8XY7: VX = VY - VX, VF = NOT borrow
-                    this->V[0xF] = this->V[Y] > this->V[X]; // Define VF
-                    this->V[X] = this->V[Y] - this->V[X];
-                } break;
-                case 0xE: // 8XYE: VX = VX << 1, VF = bit mais significativo
-                    this->V[0xF] = (this->V[X] & 0x80) >> 7;
-                    this->V[X] <<= 1;
-                    break;
-                default:
-                    printf("Instrução 8XY%X não implementada.\n", N);
-                    exit(EXIT_FAILURE);
-            }
-            break;
-
-        case 9:
-            // 9XY0: Pula a próxima instrução se VX != VY
-            if (this->V[X] != this->V[Y]) this->PC += 2;
-            break;
-
-        case 0xA:
-            // ANNN: Define I = NNN
-            this->I = NNN;
-            break;
-
-        case 0xB:
-            // BNNN: Pula para NNN + V0
-            this->PC = NNN + this->V[0];
-            break;
-
-        case 0xC:
-            // CXNN: Define VX = random_byte & NN
-            this->V[X] = (rand() % 256) & NN;
-            break;
-
-        case 0xD: {
-            // DXYN: Desenha sprite em (VX, VY) de altura N
-            uint8_t x_pos = this->V[X] % 64;
-            uint8_t y_pos = this->V[Y] % 32;
-            this->V[0xF] = 0; // Reseta VF (flag de colisão)
-
-            // Itera pelas N linhas do sprite
-            for (int i = 0; i < N; i++) {
-                uint8_t sprite_line = this->RAM[this->I + i];
-                // Itera pelos 8 bits (colunas) da linha
-                for (int j = 0; j < 8; j++) {
-                    int x = (x_pos + j);
-                    int y = (y_pos + i);
-
-                    // Ignora pixels fora da tela
-                    if (x >= 64 || y >= 32) continue; 
-                    
-                    uint8_t sprite_bit = (sprite_line & (0x80 >> j)) != 0;
-                    int screen_index = y * 64 + x;
-
-                    if (sprite_bit) {
-                        // Se o bit do sprite é 1 e o pixel na tela também é 1
-                        if (this->DISPLAY[screen_index] == 1)
-                            this->V[0xF] = 1; // Colisão!
-                        
-                        // Desenha o pixel (XOR)
-                        this->DISPLAY[screen_index] ^= 1;
-                    }
-                }
-            }
-            break;
-        }
+    this->PC = pc + 2;
 
-        case 0xE:
-            // Instruções de teclado
-            switch (NN) {
-                case 0x9E: 
-                    // EX9E: Pula a próxima instrução se a tecla em VX estiver pressionada
-                    if (this->V[X] < CHIP8_KEYS && this->KEY[this->V[X]] == 1) {
-                        this->PC += 2;
-                    }
-                    break;
-                case 0xA1: 
-                    // EXA1: Pula a próxima instrução se a tecla em VX NÃO estiver pressionada
-                    if (this->V[X] < CHIP8_KEYS && this->KEY[this->V[X]] == 0) {
-                        this->PC += 2;
-                    }
-                    break;
-                default:
-                    printf("Instrução Ex%02X não implementada.\n", NN);
-                    exit(EXIT_FAILURE);
-            }
-            break;
-
-        case 0xF:
-            // Funções diversas
-            switch (NN) {
-                case 0x07: // FX07: VX = delay_timer
-                    this->V[X] = this->delay_timer; break;
-                case 0x0A: // FX0A: Aguarda pressionar tecla, armazena em VX
-                    {
-                        bool key_pressed = false;
-                        for (int i = 0; i < CHIP8_KEYS; ++i) {
-                            if (this->KEY[i] == 1) {
-                                this->V[X] = i; 
-                                key_pressed = true;
-                                break;
-                            }
-                        }
-                        
-                        // Se nenhuma tecla foi pressionada, repete esta instrução
-                        if (!key_pressed) {
-                            this->PC -= 2; 
-                        }
-                    }
-                    break;
-                case 0x15: // FX15: delay_timer = VX
-                    this->delay_timer = this->V[X]; break;
-                case 0x18: // FX18: sound_timer = VX
-                    this->sound_timer = this->V[X]; break;
-                case 0x1E: // FX1E: I = I + VX
-                    this->I += this->V[X]; break;
-                case 0x29: // FX29: I = endereço do sprite para o dígito em VX
-                    this->I = this->V[X] * 5; break; // (Cada sprite tem 5 bytes)
-                case 0x33: // FX33: Armazena BCD de VX em I, I+1, I+2
-                    this->RAM[this->I]     = this->V[X] / 100;
-                    this->RAM[this->I + 1] = (this->V[X] / 10) % 10;
-                    this->RAM[this->I + 2] = this->V[X] % 10;
-                    break;
-                case 0x55: // FX55: Armazena V0 a VX na memória a partir de I
-                    for (int i = 0; i <= X; i++) this->RAM[this->I + i] = this->V[i];
-                    break;
-                case 0x65: // FX65: Lê V0 a VX da memória a partir de I
-                    for (int i = 0; i <= X; i++) this->V[i] = this->RAM[this->I + i];
-                    break;
-                default:
-                    printf("Instrução Fx%02X não implementada.\n", NN);
-                    exit(EXIT_FAILURE);
-            }
-            break;
-
-        default:
-            printf("Grupo não implementado! Instrução: 0x%04X\n", inst);
-            exit(EXIT_FAILURE);
+    // EXECUTE: a semântica de cada instrução está em c8ops.h
+    #define C8_CASO_OP(NOME, TIPO) case OP_##NOME: return op_##NOME<Q>(*this, d);
+    switch (d.op) {
+        C8_OPS(C8_CASO_OP)
     }
+    #undef C8_CASO_OP
+    return VM_ERRO_OPCODE_INVALIDO;
+}
+
+VM_Espera VM::VM_EmEspera() const {
+    return C8_Espera(*this);
+}
+
+VM_Status VM::VM_ExecutarInstrucao() {
+    C8_DESPACHAR_QUIRKS(this->quirks, this->VM_Passo<Q>());
+}
+
+template<class Q>
+VM_Status VM::VM_ExecutarCiclosCom(uint64_t ciclos) {
+    for (uint64_t c = 0; c < ciclos; c++) {
+        VM_Status st = this->VM_Passo<Q>();
+        if (st != VM_OK) return st;
+    }
+    return VM_OK;
+}
+
+VM_Status VM::VM_ExecutarCiclos(uint64_t ciclos) {
+    // O perfil é escolhido uma vez; o laço é especializado para ele
+    C8_DESPACHAR_QUIRKS(this->quirks, this->VM_ExecutarCiclosCom<Q>(ciclos));
+}
+
+bool VM_QuirksPorNome(const char* nome, VM_Quirks* quirks) {
+    #define C8_NOME_QUIRKS(NOME, TEXTO)    \
+        if (strcmp(nome, TEXTO) == 0) {    \
+            *quirks = VM_QUIRKS_##NOME;    \
+            return true;                   \
+        }
+    C8_LISTA_QUIRKS(C8_NOME_QUIRKS)
+    #undef C8_NOME_QUIRKS
+    return false;
+}
+
+const char* VM_NomeQuirks(VM_Quirks quirks) {
+    #define C8_TEXTO_QUIRKS(NOME, TEXTO) TEXTO,
+    static const char* const nomes[VM_NUM_QUIRKS] = { C8_LISTA_QUIRKS(C8_TEXTO_QUIRKS) };
+    #undef C8_TEXTO_QUIRKS
+    return quirks < VM_NUM_QUIRKS ? nomes[quirks] : "?";
+}
+
+VM_Extensao VM_ExtensaoQuirks(VM_Quirks quirks) {
+    C8_DESPACHAR_QUIRKS(quirks, (VM_Extensao)Q::extensao);
+}
+
+uint32_t VM_TamRAMQuirks(VM_Quirks quirks) {
+    return VM_ExtensaoQuirks(quirks) == VM_EXT_XOCHIP ? VM_TAM_RAM : VM_TAM_RAM_CHIP8;
+}
+
+bool VM_CabeNoPerfil(uint32_t tam_ram, VM_Quirks quirks, std::string* erro) {
+    if (tam_ram <= VM_TamRAMQuirks(quirks)) return true;
+    if (erro) *erro = std::string("a ROM passa de 4KB e só cabe no perfil moderno (XO-CHIP), não no '") +
+                      VM_NomeQuirks(quirks) + "'";
+    return false;
 }
 
 
@@ -352,4 +268,84 @@ void VM::VM_ImprimirRegistradores() {
     printf("PC: 0x%04X I: 0x%04X SP: 0x%02X\n", this->PC, this->I, this->SP);
     for (int i = 0; i < 16; i++) printf("V[%X]: 0x%02X ", i, this->V[i]);
     printf("\n");
-}
\ No newline at end of file
+}
+
+uint64_t VM_Fnv1a(uint64_t h, const void* dados, size_t tam) {
+    const uint8_t* p = (const uint8_t*)dados;
+    for (size_t i = 0; i < tam; i++) {
+        h ^= p[i];
+        h *= 0x100000001B3ULL;
+    }
+    return h;
+}
+
+uint8_t VM::VM_PlanosTela() const {
+    uint8_t usados = 1;
+    int palavras = this->VM_PalavrasTela();
+    for (int p = 1; p < VM_PLANOS; p++) {
+        uint64_t pixels = 0;
+        for (int i = 0; i < palavras; i++) pixels |= this->DISPLAY[p][i];
+        if (pixels) usados |= 1 << p;
+    }
+    return usados;
+}
+
+// Só a parte da tela em uso (veja VM_PalavrasTela)
+static uint64_t vm_hash_tela(uint64_t h, const VM& vm) {
+    uint8_t planos = vm.VM_PlanosTela();
+    size_t tam = vm.VM_PalavrasTela() * sizeof(uint64_t);
+    for (int p = 0; p < VM_PLANOS; p++) {
+        if (planos & (1 << p)) h = VM_Fnv1a(h, vm.DISPLAY[p], tam);
+    }
+    return h;
+}
+
+uint64_t VM::VM_HashDisplay() const {
+    uint64_t h = vm_hash_tela(VM_FNV_INICIO, *this);
+    return VM_Fnv1a(h, &this->hires, sizeof(this->hires));
+}
+
+uint64_t VM::VM_HashEstado() const {
+    // Campo a campo, para não depender de padding nem do rastro de depuração
+    uint64_t h = VM_FNV_INICIO;
+    h = VM_Fnv1a(h, this->RAM, this->tam_ram);
+    h = VM_Fnv1a(h, &this->tam_ram, sizeof(this->tam_ram));
+    h = VM_Fnv1a(h, &this->PC, sizeof(this->PC));
+    h = VM_Fnv1a(h, this->V, sizeof(this->V));
+    h = VM_Fnv1a(h, &this->SP, sizeof(this->SP));
+    h = VM_Fnv1a(h, &this->I, sizeof(this->I));
+    h = VM_Fnv1a(h, this->stack, sizeof(this->stack));
+    h = vm_hash_tela(h, *this);
+    h = VM_Fnv1a(h, this->KEY, sizeof(this->KEY));
+    h = VM_Fnv1a(h, &this->delay_timer, sizeof(this->delay_timer));
+    h = VM_Fnv1a(h, &this->sound_timer, sizeof(this->sound_timer));
+    h = VM_Fnv1a(h, &this->rng, sizeof(this->rng));
+    h = VM_Fnv1a(h, &this->hires, sizeof(this->hires));
+    h = VM_Fnv1a(h, &this->planos, sizeof(this->planos));
+    h = VM_Fnv1a(h, this->RPL, sizeof(this->RPL));
+    h = VM_Fnv1a(h, this->padrao_som, sizeof(this->padrao_som));
+    h = VM_Fnv1a(h, &this->tom_som, sizeof(this->tom_som));
+    return h;
+}
+
+const char* VM_DescreverStatus(VM_Status st) {
+    switch (st) {
+        case VM_OK:                   return "OK";
+        case VM_ERRO_PILHA_CHEIA:     return "Stack overflow em CALL";
+        case VM_ERRO_PILHA_VAZIA:     return "Stack underflow em RET";
+        case VM_ERRO_OPCODE_INVALIDO: return "Instrução não implementada";
+        case VM_PROGRAMA_ENCERRADO:   return "Programa encerrado (00FD)";
+    }
+    return "Status desconhecido";
+}
+
+#ifdef DEBUG
+void VM::VM_ImprimirRastro() {
+    // Da entrada mais antiga para a mais recente
+    uint32_t total = this->rastro_pos < VM_TAM_RASTRO ? this->rastro_pos : VM_TAM_RASTRO;
+    for (uint32_t i = 0; i < total; i++) {
+        const VM_EntradaRastro& r = this->rastro[(this->rastro_pos - total + i) % VM_TAM_RASTRO];
+        printf("0x%03X: 0x%04X\n", r.pc, r.inst);
+    }
+}
+#endif
\ No newline at end of file
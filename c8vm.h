@@ -1,29 +1,261 @@
+#ifndef C8VM_H
+#define C8VM_H
+
+#include <stddef.h>
 #include <stdint.h>
+#include <memory>
+#include <string>
 #include "defs.h" // Inclui o CHIP8_KEYS
 
 //Autores: Guilherme Inoe, Winicius Abilio
 
-class VM {
+// Resultado da execução. Falhas não encerram mais o processo: quem chama
+// decide o que fazer (vários VMs podem dividir o mesmo processo).
+enum VM_Status {
+    VM_OK = 0,
+    VM_ERRO_PILHA_CHEIA,      // 2NNN com a pilha cheia (stack overflow)
+    VM_ERRO_PILHA_VAZIA,      // 00EE com a pilha vazia (stack underflow)
+    VM_ERRO_OPCODE_INVALIDO,  // Instrução desconhecida
+    VM_PROGRAMA_ENCERRADO     // 00FD (SCHIP): a ROM pediu para sair
+};
+
+const char* VM_DescreverStatus(VM_Status st);
+
+// FNV-1a de 64 bits, continuando a partir de 'h' (comece com VM_FNV_INICIO)
+uint64_t VM_Fnv1a(uint64_t h, const void* dados, size_t tam);
+#define VM_FNV_INICIO 0xCBF29CE484222325ULL
+
+// Espera ocupada em que a VM está parada (veja VM::VM_EmEspera)
+enum VM_Espera {
+    VM_ESPERA_NENHUMA = 0,
+    VM_ESPERA_TIMER,          // Laço FX07/3XNN/1NNN: só muda quando o delay_timer andar
+    VM_ESPERA_ENTRADA         // FX0A sem tecla ou salto para si mesmo: só muda com entrada
+};
+
+// Perfis de compatibilidade ("quirks"). As variantes do CHIP-8 discordam em
+// alguns detalhes; cada perfil escolhe um comportamento para cada um:
+//
+//                8XY6/8XYE   FX55/FX65    BNNN          8XY1/2/3   DXYN na borda
+//   padrao       VX          I fixo       NNN + V0      VF mantido corta
+//   vip          VY          I += X + 1   NNN + V0      VF = 0     corta
+//   chip48       VX          I += X       XNN + VX      VF mantido corta
+//   schip        VX          I fixo       XNN + VX      VF mantido corta
+//   moderno      VY          I += X + 1   NNN + V0      VF mantido dá a volta
+//
+// 'padrao' é o comportamento histórico deste emulador (roda tanto as ROMs
+// do VIP quanto as conversões do CHIP-48/SUPER-CHIP da pasta de testes);
+// 'moderno' é o do Octo/XO-CHIP. Os motores geram um laço especializado
+// por perfil (veja C8_Quirks em c8ops.h): o perfil não custa nada por
+// instrução.
+//
+// O perfil também diz quais extensões do conjunto de instruções existem
+// (VM_Extensao): 'schip' tem as do SUPER-CHIP e 'moderno' as do XO-CHIP,
+// com 64KB de RAM mesmo para uma ROM pequena. Nos outros perfis essas
+// instruções são inválidas (VM_ERRO_OPCODE_INVALIDO), como no CHIP-8, e a
+// RAM tem 4KB: uma ROM maior só roda no 'moderno'.
+#define C8_LISTA_QUIRKS(X) \
+    X(PADRAO, "padrao")    \
+    X(VIP, "vip")          \
+    X(CHIP48, "chip48")    \
+    X(SCHIP, "schip")      \
+    X(MODERNO, "moderno")
+
+enum VM_Quirks {
+    #define C8_ENUM_QUIRKS(NOME, TEXTO) VM_QUIRKS_##NOME,
+    C8_LISTA_QUIRKS(C8_ENUM_QUIRKS)
+    #undef C8_ENUM_QUIRKS
+    VM_NUM_QUIRKS
+};
+
+#define QUIRKS_DISPONIVEIS "padrao, vip, chip48, schip, moderno"
+
+// Perfil pelo nome (veja QUIRKS_DISPONIVEIS). Retorna false se não existir.
+bool VM_QuirksPorNome(const char* nome, VM_Quirks* quirks);
+const char* VM_NomeQuirks(VM_Quirks quirks);
+
+// Extensões habilitadas por um perfil. Cada nível inclui o anterior.
+enum VM_Extensao {
+    VM_EXT_CHIP8 = 0,   // Só as instruções do CHIP-8
+    VM_EXT_SCHIP,       // + 00CN, 00FB-00FF, FX30, FX75, FX85
+    VM_EXT_XOCHIP       // + 00DN, 5XY2, 5XY3, F000 NNNN, FN01, F002, FX3A e 64KB de RAM
+};
+
+VM_Extensao VM_ExtensaoQuirks(VM_Quirks quirks);
+// Tamanho da RAM no perfil 'quirks': VM_TAM_RAM no XO-CHIP, senão
+// VM_TAM_RAM_CHIP8. É o único lugar que decide o tamanho da RAM de uma VM.
+uint32_t VM_TamRAMQuirks(VM_Quirks quirks);
+// Se uma RAM inicial de 'tam_ram' bytes (ex: ImagemROM::tam_ram) cabe no
+// perfil 'quirks'. Senão preenche 'erro' (se não for NULL).
+bool VM_CabeNoPerfil(uint32_t tam_ram, VM_Quirks quirks, std::string* erro);
+
+// Memória: 4KB no CHIP-8 e no SUPER-CHIP, 64KB no XO-CHIP (veja
+// VM_Memoria). Todo endereço da ROM (PC, I + n) é mascarado com tam_ram - 1 antes de
+// tocar a RAM, como em um barramento de 12 ou 16 bits: não há teste de
+// limite por acesso, e nenhum endereço sai do vetor.
+#define VM_TAM_RAM_CHIP8 4096
+#define VM_TAM_RAM 65536
+
+// A RAM é dividida em páginas para os estados copy-on-write (c8estado.h)
+#define VM_TAM_PAGINA 256
+#define VM_NUM_PAGINAS (VM_TAM_RAM / VM_TAM_PAGINA)
+
+// Tela: 64x32 (lores) ou 128x64 (hires, SUPER-CHIP/XO-CHIP) em até
+// VM_PLANOS planos de bits (XO-CHIP: 4 cores). Cada plano é um vetor de
+// palavras de 64 bits com x = 0 no bit mais alto:
+//   lores: linha y (0-31) = palavra y
+//   hires: linha y (0-63) = palavras 2y (x 0-63) e 2y + 1 (x 64-127)
+// Trocar de modo (00FE/00FF) limpa a tela, então as duas formas nunca se
+// misturam.
+#define VM_PLANOS 2
+#define VM_PALAVRAS_TELA 128
+
+// Fontes na RAM: 16 dígitos de 5 bytes (FX29) e, logo depois, 16 dígitos
+// grandes 8x10 do SUPER-CHIP/XO-CHIP (FX30)
+#define VM_ENDERECO_FONTE 0x000
+#define VM_ENDERECO_FONTE_GRANDE 0x050
+
+// RAM de uma VM recém-inicializada (VM_TAM_RAM_CHIP8 bytes): as fontes no
+// lugar e o resto zerado
+const uint8_t* VM_RAMInicial();
+
+// Semente do gerador do CXNN após VM_Inicializar
+#define VM_SEMENTE_PADRAO 0
+
+#ifdef DEBUG
+// Rastro de execução: buffer circular binário com as últimas instruções
+#define VM_TAM_RASTRO 256
+
+struct VM_EntradaRastro {
+    uint16_t pc;
+    uint16_t inst;
+};
+#endif
+
+// RAM de uma VM. Os 4KB do CHIP-8/SUPER-CHIP ficam dentro do próprio
+// objeto, então uma VM desses perfis tem uns 6KB e é copiada sem alocar
+// (cache de estados, GrupoVM, bifurcações); os 64KB do XO-CHIP são alocados
+// à parte, só quando a VM passa a usá-los. RAM aponta para o vetor em uso e
+// a cópia de uma VM leva só os tam_ram bytes dele.
+class VM_Memoria {
+public:
+    uint8_t* RAM;           // Memória (tam_ram bytes)
+    uint32_t tam_ram;       // VM_TAM_RAM_CHIP8 ou VM_TAM_RAM (XO-CHIP). Mude só com VM_TrocarTamRAM.
+
+    VM_Memoria();
+    VM_Memoria(const VM_Memoria& outra);
+    VM_Memoria& operator=(const VM_Memoria& outra);
+
+    // Passa a usar o vetor de 'tam_ram' bytes. O conteúdo não é copiado de
+    // um vetor para o outro: quem troca preenche a RAM em seguida.
+    void VM_TrocarTamRAM(uint32_t tam_ram);
+
+private:
+    uint8_t ram_chip8[VM_TAM_RAM_CHIP8];
+    std::unique_ptr<uint8_t[]> ram_xochip; // Mantida ao voltar para 4KB, para a próxima troca
+};
+
+class VM : public VM_Memoria {
 public:
-    uint8_t RAM[4096];      // Memória 4KB
     uint16_t PC;            // Program Counter
     uint8_t V[16];          // Registradores de propósito geral
     uint8_t SP;             // Stack Pointer
     uint16_t I;             // Registrador de índice
     uint16_t stack[16];     // Pilha
-    uint8_t DISPLAY[64*32]; // Tela
+    uint64_t DISPLAY[VM_PLANOS][VM_PALAVRAS_TELA]; // Planos da tela (veja VM_PALAVRAS_TELA)
+    uint8_t hires;          // 1 = tela 128x64 (00FF), 0 = 64x32 (00FE)
+    uint8_t planos;         // Planos afetados por DXYN/00E0/scroll, bit p = plano p (FN01)
+    uint64_t linhas_alteradas; // Bit y ligado = linha y mudou (desenho/scroll/limpeza). Quem desenha zera.
+    uint64_t paginas_alteradas[VM_NUM_PAGINAS / 64]; // Bit p = página p da RAM foi escrita (FX33/FX55/5XY2). Zerado por c8estado.h.
+    uint8_t RPL[16];        // "Flags RPL" do SUPER-CHIP/XO-CHIP (FX75/FX85)
+    uint8_t padrao_som[16]; // Padrão de áudio do XO-CHIP (F002)
+    uint8_t tom_som;        // Altura do padrão de áudio do XO-CHIP (FX3A)
     uint8_t KEY[CHIP8_KEYS]; // Estado do teclado (novo)
     uint8_t delay_timer;
     uint8_t sound_timer;
+    uint32_t rng;           // Estado do xorshift32 usado pelo CXNN (nunca zero)
+    uint8_t quirks;         // VM_Quirks usado na execução (não faz parte do estado salvo; veja VM_DefinirQuirks)
+
+    #ifdef DEBUG
+    bool rastro_ativo;      // Liga/desliga a gravação do rastro em tempo de execução
+    uint32_t rastro_pos;    // Total de instruções gravadas (posição = rastro_pos % VM_TAM_RASTRO)
+    VM_EntradaRastro rastro[VM_TAM_RASTRO];
+    #endif
 
+    // Também volta o gerador do CXNN para VM_SEMENTE_PADRAO: a mesma ROM com
+    // a mesma entrada sempre dá o mesmo resultado. Use VM_Semear depois para
+    // outra sequência. O perfil de quirks volta para VM_QUIRKS_PADRAO.
     void VM_Inicializar(uint16_t pc_inicial);
-    void VM_CarregarROM(char* arq_rom, uint16_t pc_inicial);
+    // Igual, mas a RAM inicial (tam_ram bytes) é copiada de 'ram' em vez
+    // de ser só as fontes (ex: ImagemROM::RAM, veja c8rom.h)
+    void VM_Inicializar(uint16_t pc_inicial, const uint8_t* ram, uint32_t tam_ram);
+    void VM_Semear(uint64_t semente);
+
+    // Troca o perfil de quirks e passa a RAM para o tamanho dele
+    // (VM_TamRAMQuirks), com a parte nova zerada. Se a VM já usa mais RAM
+    // do que o perfil tem (uma ROM de mais de 4KB fora do XO-CHIP), retorna
+    // false, preenche 'erro' e não altera a VM.
+    bool VM_DefinirQuirks(VM_Quirks quirks, std::string* erro);
+
+    // Aumenta a RAM para 'tam_ram' bytes, mantendo o conteúdo e zerando a
+    // parte nova (não faz nada se a RAM já for desse tamanho)
+    void VM_CrescerRAM(uint32_t tam_ram);
+
+    // Copia a ROM para a RAM a partir de 'pc_inicial' (lida pelo cache de
+    // c8rom.h: o arquivo só é lido na primeira vez). Não mexe no resto da
+    // VM. A ROM tem que caber na RAM do perfil atual: defina o perfil antes
+    // (VM_DefinirQuirks). Em caso de erro a VM não é alterada.
+    bool VM_CarregarROM(const char* arq_rom, uint16_t pc_inicial, std::string* erro);
     
-    void VM_ExecutarInstrucao();
+    VM_Status VM_ExecutarInstrucao();
+
+    // Executa 'ciclos' instruções em um único laço, sem retornar ao chamador
+    // entre elas. Não processa timers nem entrada: isso continua com o frontend.
+    // Para na primeira falha e a retorna.
+    VM_Status VM_ExecutarCiclos(uint64_t ciclos);
 
     void VM_ProcessarInput(uint8_t key_index, bool is_down);
     
     void VM_ProcessarTimers(); 
 
     void VM_ImprimirRegistradores();
+
+    // Reconhece se o PC está em uma espera ocupada que não muda o estado da
+    // VM até o próximo tick dos timers ou a próxima tecla. Os motores cache
+    // e blocos usam isso para pular os ciclos restantes do quadro; o
+    // frontend, para dormir em vez de emular quadros vazios.
+    VM_Espera VM_EmEspera() const;
+
+    // Hash (FNV-1a 64) do estado completo da máquina (RAM, registradores,
+    // pilha, timers, teclado, tela, gerador do CXNN e estado das extensões)
+    // e só da tela
+    uint64_t VM_HashEstado() const;
+    uint64_t VM_HashDisplay() const;
+
+    // Tamanho da tela no modo atual
+    inline int VM_Largura() const { return this->hires ? 128 : 64; }
+    inline int VM_Altura() const { return this->hires ? 64 : 32; }
+
+    // Parte da tela em uso, a única que os hashes e os estados salvos
+    // percorrem: as palavras de cada plano no modo atual (32 em lores, 128
+    // em hires; as outras são sempre zero) e os planos com algum pixel
+    // (bit p = plano p; o primeiro plano sempre conta)
+    inline int VM_PalavrasTela() const { return this->hires ? VM_PALAVRAS_TELA : VM_PALAVRAS_TELA / 4; }
+    uint8_t VM_PlanosTela() const;
+
+    // Cor (bit p = plano p) do pixel (x, y) da tela no modo atual
+    inline int VM_Pixel(int x, int y) const {
+        int palavra = this->hires ? 2 * y + x / 64 : y;
+        int bit = 63 - x % 64;
+        return ((this->DISPLAY[0][palavra] >> bit) & 1) | (((this->DISPLAY[1][palavra] >> bit) & 1) << 1);
+    }
+
+    #ifdef DEBUG
+    void VM_ImprimirRastro();
+    #endif
+
+private:
+    template<class Q> VM_Status VM_Passo();
+    template<class Q> VM_Status VM_ExecutarCiclosCom(uint64_t ciclos);
 };
+
+#endif
@@ -0,0 +1,401 @@
+#include "conformidade.h"
+#include "c8motor.h"
+#include "c8rom.h"
+#include "c8analise.h"
+#include "lote.h"
+#include "sessao.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <map>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+struct PontoConformidade {
+    uint64_t quadro;
+    uint64_t hash_estado;
+    uint64_t hash_display;
+    VM_Status status;
+};
+
+// Nome da ROM no arquivo de pontos: sem o diretório, para o mesmo arquivo
+// valer de qualquer lugar
+static std::string conformidade_nome(const std::string& rom) {
+    size_t barra = rom.find_last_of("/\\");
+    return barra == std::string::npos ? rom : rom.substr(barra + 1);
+}
+
+static std::string conformidade_chave(const std::string& nome, VM_Quirks quirks, uint64_t quadro) {
+    char buf[32];
+    snprintf(buf, sizeof(buf), " %s %llu", VM_NomeQuirks(quirks), (unsigned long long)quadro);
+    return nome + buf;
+}
+
+// VM no estado inicial da sessão, com o motor preaquecido como no lote
+static bool conformidade_preparar(VM& vm, Motor& motor, const std::string& rom, VM_Quirks quirks, std::string* erro) {
+    const ImagemROM* img = ROM_Carregar(rom.c_str(), 0x200, erro);
+    if (img == NULL) return false;
+
+    AnaliseROM analise;
+    Analise_ROM(*img, quirks, &analise);
+    vm.VM_Inicializar(img->pc_inicial, img->RAM.data(), img->tam_ram);
+    vm.VM_Semear(CONFORMIDADE_SEMENTE);
+    if (!vm.VM_DefinirQuirks(quirks, erro)) return false;
+    motor.InvalidarTudo();
+    motor.Preaquecer(vm, analise);
+    return true;
+}
+
+static void conformidade_rodar(VM& vm, Motor& motor, int hz, const std::vector<EventoEntrada>& eventos,
+                               std::vector<PontoConformidade>& pontos) {
+    size_t prox_evento = 0;
+    for (uint64_t quadro = 0; quadro < CONFORMIDADE_QUADROS; quadro++) {
+        Sessao_AplicarEntrada(vm, quadro, eventos, &prox_evento);
+        VM_Status st = motor.Executar(vm, Sessao_CiclosQuadro(quadro, hz));
+        if (st == VM_OK) vm.VM_ProcessarTimers();
+
+        if (st != VM_OK || (quadro + 1) % CONFORMIDADE_INTERVALO == 0) {
+            PontoConformidade p = { quadro + 1, vm.VM_HashEstado(), vm.VM_HashDisplay(), st };
+            pontos.push_back(p);
+        }
+        if (st != VM_OK) return;
+    }
+}
+
+// Pontos esperados pela chave "<rom> <perfil> <quadro>"
+static bool conformidade_ler(const char* caminho, std::map<std::string, PontoConformidade>& esperados) {
+    FILE* arq = fopen(caminho, "r");
+    if (!arq) {
+        fprintf(stderr, "Erro: não foi possível abrir '%s' (gere com --gerar)\n", caminho);
+        return false;
+    }
+
+    char linha[1024];
+    int num_linha = 0;
+    while (fgets(linha, sizeof(linha), arq)) {
+        num_linha++;
+        std::vector<std::string> campos = Lote_Campos(linha);
+        if (campos.empty()) continue;
+
+        VM_Quirks quirks;
+        if (campos.size() != 6 || !VM_QuirksPorNome(campos[1].c_str(), &quirks)) {
+            fprintf(stderr, "Erro: %s:%d: esperado '<rom> <perfil> <quadro> <hash_estado> <hash_display> <status>'\n",
+                    caminho, num_linha);
+            fclose(arq);
+            return false;
+        }
+
+        PontoConformidade p;
+        p.quadro = strtoull(campos[2].c_str(), NULL, 10);
+        p.hash_estado = strtoull(campos[3].c_str(), NULL, 16);
+        p.hash_display = strtoull(campos[4].c_str(), NULL, 16);
+        p.status = (VM_Status)atoi(campos[5].c_str());
+        esperados[conformidade_chave(campos[0], quirks, p.quadro)] = p;
+    }
+    fclose(arq);
+    return true;
+}
+
+static bool conformidade_roteiro(const char* roteiro, std::vector<EventoEntrada>& eventos) {
+    if (roteiro == NULL) return true;
+    std::string erro;
+    if (Sessao_LerRoteiro(roteiro, eventos, &erro)) return true;
+    fprintf(stderr, "Erro: %s\n", erro.c_str());
+    return false;
+}
+
+int Conformidade_Executar(const char* esperado, bool gerar, const std::vector<std::string>& roms,
+                          const char* roteiro, const char* nome_motor, int hz) {
+    Motor* motor = Motor_Criar(nome_motor);
+    if (motor == NULL) {
+        fprintf(stderr, "Erro: Motor desconhecido '%s' (use: %s)\n", nome_motor, MOTORES_DISPONIVEIS);
+        return 1;
+    }
+
+    std::vector<EventoEntrada> eventos;
+    std::map<std::string, PontoConformidade> esperados;
+    if (!conformidade_roteiro(roteiro, eventos) || (!gerar && !conformidade_ler(esperado, esperados))) {
+        delete motor;
+        return 1;
+    }
+
+    FILE* saida = NULL;
+    if (gerar) {
+        saida = fopen(esperado, "w");
+        if (!saida) {
+            fprintf(stderr, "Erro: não foi possível criar '%s'\n", esperado);
+            delete motor;
+            return 1;
+        }
+        fprintf(saida, "# Pontos de controle de 'chip8_headless --conformidade' (semente %d, %d quadros, %d Hz).\n"
+                       "# <rom> <perfil> <quadro> <hash_estado> <hash_display> <status>\n",
+                CONFORMIDADE_SEMENTE, CONFORMIDADE_QUADROS, hz);
+    }
+
+    VM vm;
+    int sessoes = 0, falhas = 0;
+    for (size_t r = 0; r < roms.size(); r++) {
+        std::string nome = conformidade_nome(roms[r]);
+        for (int q = 0; q < VM_NUM_QUIRKS; q++) {
+            VM_Quirks quirks = (VM_Quirks)q;
+            sessoes++;
+            printf("{\"rom\":");
+            Lote_JsonTexto(nome);
+            printf(",\"quirks\":\"%s\",\"motor\":\"%s\"", VM_NomeQuirks(quirks), nome_motor);
+
+            std::string erro;
+            if (!conformidade_preparar(vm, *motor, roms[r], quirks, &erro)) {
+                printf(",\"erro\":");
+                Lote_JsonTexto(erro);
+                printf("}\n");
+                falhas++;
+                continue;
+            }
+
+            std::vector<PontoConformidade> pontos;
+            conformidade_rodar(vm, *motor, hz, eventos, pontos);
+            printf(",\"pontos\":%zu", pontos.size());
+
+            if (gerar) {
+                for (size_t i = 0; i < pontos.size(); i++) {
+                    const PontoConformidade& p = pontos[i];
+                    if (nome.find(' ') != std::string::npos) fprintf(saida, "\"%s\"", nome.c_str());
+                    else fputs(nome.c_str(), saida);
+                    fprintf(saida, " %s %llu %016llx %016llx %d\n", VM_NomeQuirks(quirks),
+                            (unsigned long long)p.quadro, (unsigned long long)p.hash_estado,
+                            (unsigned long long)p.hash_display, (int)p.status);
+                }
+                printf("}\n");
+                continue;
+            }
+
+            // Primeiro ponto que falta ou diverge
+            size_t i = 0;
+            std::map<std::string, PontoConformidade>::const_iterator e;
+            for (; i < pontos.size(); i++) {
+                e = esperados.find(conformidade_chave(nome, quirks, pontos[i].quadro));
+                if (e == esperados.end()) break;
+                const PontoConformidade& p = e->second;
+                if (p.hash_estado != pontos[i].hash_estado || p.hash_display != pontos[i].hash_display ||
+                    p.status != pontos[i].status) break;
+            }
+            if (i == pontos.size()) {
+                printf(",\"identico\":true}\n");
+                continue;
+            }
+
+            falhas++;
+            const PontoConformidade& p = pontos[i];
+            printf(",\"identico\":false,\"quadro\":%llu,\"hash_estado\":\"%016llx\",\"hash_display\":\"%016llx\","
+                   "\"status\":\"%s\"", (unsigned long long)p.quadro, (unsigned long long)p.hash_estado,
+                   (unsigned long long)p.hash_display, VM_DescreverStatus(p.status));
+            if (e == esperados.end()) {
+                printf(",\"esperado\":null}\n");
+            } else {
+                printf(",\"esperado\":{\"hash_estado\":\"%016llx\",\"hash_display\":\"%016llx\",\"status\":\"%s\"}}\n",
+                       (unsigned long long)e->second.hash_estado, (unsigned long long)e->second.hash_display,
+                       VM_DescreverStatus(e->second.status));
+            }
+        }
+    }
+
+    printf("{\"sessoes\":%d,\"falhas\":%d,\"motor\":\"%s\"%s}\n", sessoes, falhas, nome_motor,
+           gerar ? ",\"gerado\":true" : "");
+    delete motor;
+    if (saida && fclose(saida) != 0) {
+        fprintf(stderr, "Erro: falha ao gravar '%s'\n", esperado);
+        return 1;
+    }
+    return falhas ? 1 : 0;
+}
+
+static void conformidade_campo(std::string& s, const char* nome, unsigned long long a, unsigned long long b) {
+    if (a == b) return;
+    char buf[96];
+    snprintf(buf, sizeof(buf), "%s%s 0x%llX != 0x%llX", s.empty() ? "" : ", ", nome, a, b);
+    s += buf;
+}
+
+// O que difere entre os estados das duas VMs (vazio = iguais). Vetores
+// grandes (RAM, tela) mostram a primeira posição diferente e quantas são.
+static std::string conformidade_diferencas(const VM& a, const VM& b) {
+    std::string s;
+    char nome[32];
+    conformidade_campo(s, "tam_ram", a.tam_ram, b.tam_ram);
+    conformidade_campo(s, "PC", a.PC, b.PC);
+    conformidade_campo(s, "I", a.I, b.I);
+    conformidade_campo(s, "SP", a.SP, b.SP);
+    for (int i = 0; i < 16; i++) {
+        snprintf(nome, sizeof(nome), "V%X", i);
+        conformidade_campo(s, nome, a.V[i], b.V[i]);
+    }
+    for (int i = 0; i < 16; i++) {
+        snprintf(nome, sizeof(nome), "stack[%d]", i);
+        conformidade_campo(s, nome, a.stack[i], b.stack[i]);
+    }
+    conformidade_campo(s, "delay_timer", a.delay_timer, b.delay_timer);
+    conformidade_campo(s, "sound_timer", a.sound_timer, b.sound_timer);
+    conformidade_campo(s, "rng", a.rng, b.rng);
+    conformidade_campo(s, "hires", a.hires, b.hires);
+    conformidade_campo(s, "planos", a.planos, b.planos);
+    conformidade_campo(s, "tom_som", a.tom_som, b.tom_som);
+    for (int i = 0; i < 16; i++) {
+        snprintf(nome, sizeof(nome), "KEY[%X]", i);
+        conformidade_campo(s, nome, a.KEY[i], b.KEY[i]);
+        snprintf(nome, sizeof(nome), "RPL[%d]", i);
+        conformidade_campo(s, nome, a.RPL[i], b.RPL[i]);
+        snprintf(nome, sizeof(nome), "padrao_som[%d]", i);
+        conformidade_campo(s, nome, a.padrao_som[i], b.padrao_som[i]);
+    }
+
+    uint32_t tam = a.tam_ram < b.tam_ram ? a.tam_ram : b.tam_ram;
+    uint32_t difs = 0, primeira = 0;
+    for (uint32_t i = 0; i < tam; i++) {
+        if (a.RAM[i] != b.RAM[i] && difs++ == 0) primeira = i;
+    }
+    if (difs) {
+        snprintf(nome, sizeof(nome), "RAM[0x%03X]", primeira);
+        conformidade_campo(s, nome, a.RAM[primeira], b.RAM[primeira]);
+        snprintf(nome, sizeof(nome), " (%u bytes)", difs);
+        s += nome;
+    }
+
+    difs = 0;
+    for (int p = 0; p < VM_PLANOS; p++) {
+        for (int i = 0; i < VM_PALAVRAS_TELA; i++) {
+            if (a.DISPLAY[p][i] != b.DISPLAY[p][i] && difs++ == 0) {
+                snprintf(nome, sizeof(nome), "DISPLAY[%d][%d]", p, i);
+                conformidade_campo(s, nome, a.DISPLAY[p][i], b.DISPLAY[p][i]);
+            }
+        }
+    }
+    if (difs) {
+        snprintf(nome, sizeof(nome), " (%u palavras)", difs);
+        s += nome;
+    }
+    return s;
+}
+
+// Refaz o quadro a partir das cópias, uma instrução de cada vez nos dois
+// motores, até a primeira diferença. Imprime os campos JSON dela e retorna
+// false se o quadro passo a passo não divergir (ex: só com o pulo de
+// espera ocupada de um motor, que roda o quadro inteiro).
+static bool conformidade_passo_a_passo(VM& a, VM& b, Motor& motor_a, Motor& motor_b, uint64_t ciclos) {
+    motor_a.InvalidarTudo();
+    motor_b.InvalidarTudo();
+    for (uint64_t i = 0; i < ciclos; i++) {
+        uint16_t pc = a.PC & (a.tam_ram - 1); // Como a busca vê o PC
+        char texto[64] = "";
+        Analise_Desmontar(a.RAM, a.tam_ram, pc, texto, sizeof(texto));
+        unsigned inst = (a.RAM[pc] << 8) | a.RAM[(pc + 1) & (a.tam_ram - 1)];
+
+        VM_Status st_a = motor_a.Executar(a, 1);
+        VM_Status st_b = motor_b.Executar(b, 1);
+        std::string difs = conformidade_diferencas(a, b);
+        if (st_a == st_b && difs.empty()) {
+            if (st_a != VM_OK) return false;
+            continue;
+        }
+
+        printf(",\"instrucao\":%llu,\"pc\":\"0x%03X\",\"opcode\":\"%04X\",\"desmontagem\":",
+               (unsigned long long)i, pc, inst);
+        Lote_JsonTexto(texto);
+        printf(",\"status_a\":\"%s\",\"status_b\":\"%s\",\"diferencas\":",
+               VM_DescreverStatus(st_a), VM_DescreverStatus(st_b));
+        Lote_JsonTexto(difs);
+        return true;
+    }
+    return false;
+}
+
+int Conformidade_Diferencial(const char* motor_a, const char* motor_b, const std::vector<std::string>& roms,
+                             const char* roteiro, int hz) {
+    Motor* ma = Motor_Criar(motor_a);
+    Motor* mb = Motor_Criar(motor_b);
+    if (ma == NULL || mb == NULL) {
+        fprintf(stderr, "Erro: Motor desconhecido '%s' (use: %s)\n", ma == NULL ? motor_a : motor_b, MOTORES_DISPONIVEIS);
+        delete ma;
+        delete mb;
+        return 1;
+    }
+
+    std::vector<EventoEntrada> eventos;
+    if (!conformidade_roteiro(roteiro, eventos)) {
+        delete ma;
+        delete mb;
+        return 1;
+    }
+
+    VM a, b, copia_a, copia_b; // As cópias guardam o início do quadro
+    int sessoes = 0, falhas = 0;
+    for (size_t r = 0; r < roms.size(); r++) {
+        for (int q = 0; q < VM_NUM_QUIRKS; q++) {
+            VM_Quirks quirks = (VM_Quirks)q;
+            sessoes++;
+            printf("{\"rom\":");
+            Lote_JsonTexto(conformidade_nome(roms[r]));
+            printf(",\"quirks\":\"%s\",\"motor_a\":\"%s\",\"motor_b\":\"%s\"", VM_NomeQuirks(quirks), motor_a, motor_b);
+
+            std::string erro;
+            if (!conformidade_preparar(a, *ma, roms[r], quirks, &erro) ||
+                !conformidade_preparar(b, *mb, roms[r], quirks, &erro)) {
+                printf(",\"erro\":");
+                Lote_JsonTexto(erro);
+                printf("}\n");
+                falhas++;
+                continue;
+            }
+
+            size_t prox_evento = 0, prox_quadro = 0;
+            uint64_t quadro = 0, ciclos_total = 0;
+            bool diverge = false;
+            for (; quadro < CONFORMIDADE_QUADROS; quadro++) {
+                copia_a = a;
+                copia_b = b;
+                prox_quadro = prox_evento;
+                size_t prox_b = prox_evento;
+                uint64_t ciclos = Sessao_CiclosQuadro(quadro, hz);
+
+                Sessao_AplicarEntrada(a, quadro, eventos, &prox_evento);
+                Sessao_AplicarEntrada(b, quadro, eventos, &prox_b);
+                VM_Status st_a = ma->Executar(a, ciclos);
+                VM_Status st_b = mb->Executar(b, ciclos);
+                if (st_a == VM_OK) a.VM_ProcessarTimers();
+                if (st_b == VM_OK) b.VM_ProcessarTimers();
+
+                if (st_a != st_b || a.VM_HashEstado() != b.VM_HashEstado()) {
+                    diverge = true;
+                    break;
+                }
+                if (st_a != VM_OK) break;
+                ciclos_total += ciclos;
+            }
+
+            if (!diverge) {
+                printf(",\"quadros\":%llu,\"ciclos\":%llu,\"identico\":true}\n",
+                       (unsigned long long)quadro, (unsigned long long)ciclos_total);
+                continue;
+            }
+
+            // Volta ao início do quadro divergente
+            falhas++;
+            printf(",\"identico\":false,\"quadro\":%llu,\"ciclo\":%llu",
+                   (unsigned long long)quadro, (unsigned long long)ciclos_total);
+            a = copia_a;
+            b = copia_b;
+            size_t prox_a = prox_quadro, prox_b = prox_quadro;
+            Sessao_AplicarEntrada(a, quadro, eventos, &prox_a);
+            Sessao_AplicarEntrada(b, quadro, eventos, &prox_b);
+            if (!conformidade_passo_a_passo(a, b, *ma, *mb, Sessao_CiclosQuadro(quadro, hz))) {
+                printf(",\"instrucao\":null,\"diferencas\":");
+                Lote_JsonTexto("só no quadro inteiro (passo a passo os motores concordam)");
+            }
+            printf("}\n");
+        }
+    }
+
+    printf("{\"sessoes\":%d,\"falhas\":%d,\"motor_a\":\"%s\",\"motor_b\":\"%s\"}\n", sessoes, falhas, motor_a, motor_b);
+    delete ma;
+    delete mb;
+    return falhas ? 1 : 0;
+}
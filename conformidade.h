@@ -0,0 +1,41 @@
+#ifndef CONFORMIDADE_H
+#define CONFORMIDADE_H
+
+#include <string>
+#include <vector>
+#include "c8vm.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Testes de conformidade ("make test"). Cada ROM roda sem janela em todos
+// os perfis de quirks, com a semente CONFORMIDADE_SEMENTE e o roteiro de
+// entrada 'roteiro' (NULL = sem entrada), por CONFORMIDADE_QUADROS quadros
+// de 60Hz. A cada CONFORMIDADE_INTERVALO quadros (e no fim, se a VM parar
+// antes) o hash do estado completo e o da tela viram um ponto de controle.
+//
+// O arquivo de pontos esperados tem uma linha por ponto:
+//
+//     <rom> <perfil> <quadro> <hash_estado> <hash_display> <status>
+//
+// com o nome do arquivo da ROM sem o diretório (aspas se tiver espaço).
+
+#define CONFORMIDADE_SEMENTE 1
+#define CONFORMIDADE_QUADROS 1800
+#define CONFORMIDADE_INTERVALO 120
+
+// Roda as ROMs no motor 'nome_motor' e compara os pontos com os de
+// 'esperado' (ou, com 'gerar', grava o arquivo). Imprime uma linha JSON por
+// sessão com o primeiro ponto divergente. Retorna != 0 se algum ponto
+// divergir, faltar no arquivo ou a sessão não puder rodar.
+int Conformidade_Executar(const char* esperado, bool gerar, const std::vector<std::string>& roms,
+                          const char* roteiro, const char* nome_motor, int hz);
+
+// Modo diferencial: roda as mesmas sessões em dois motores lado a lado e
+// compara o estado a cada quadro. Quando um quadro diverge, ele é refeito
+// instrução por instrução a partir de cópias das VMs para achar a primeira
+// instrução divergente (PC, desmontagem e o que ficou diferente). Imprime
+// uma linha JSON por sessão e retorna != 0 se alguma divergir.
+int Conformidade_Diferencial(const char* motor_a, const char* motor_b, const std::vector<std::string>& roms,
+                             const char* roteiro, int hz);
+
+#endif
@@ -1,2 +1,8 @@
-#define DEBUG 1
-#define CHIP8_KEYS 16
\ No newline at end of file
+#ifndef DEFS_H
+#define DEFS_H
+
+// DEBUG não é mais fixo aqui: compile com "make DEBUG=1" para ter o rastro
+// de instruções (veja VM_ImprimirRastro)
+#define CHIP8_KEYS 16
+
+#endif
\ No newline at end of file
@@ -0,0 +1,314 @@
+#include "c8vm.h"
+#include "c8motor.h"
+#include "sessao.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <vector>
+
+#ifndef C8_LIBFUZZER
+#include <dirent.h>
+#include <fcntl.h>
+#include <signal.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <chrono>
+#include <random>
+#include <string>
+#endif
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Alvo de fuzzing do núcleo: cada entrada vira uma ROM, um perfil de quirks
+// e uma sequência de teclas, executada por no máximo FUZZ_QUADROS quadros
+// nos três motores. Compilado com os sanitizers (make fuzz), qualquer
+// acesso fora dos vetores da VM derruba o processo; além disso a entrada
+// falha (abort) se os motores terminarem em estados diferentes ou se a VM
+// ficar em um estado impossível (SP > 16, tam_ram trocado...).
+//
+// Formato da entrada (bytes que faltam valem 0):
+//   byte 0      perfil de quirks (% VM_NUM_QUIRKS), que também dá o tamanho da RAM
+//   byte 1      número de eventos de entrada (% FUZZ_MAX_EVENTOS)
+//   2 bytes     por evento: quadro, tecla (bits 0-3) e apertada (bit 4)
+//   resto       a ROM, carregada em 0x200 (cortada no fim da RAM do perfil)
+//
+// Com -DC8_LIBFUZZER só existe LLVMFuzzerTestOneInput (make fuzz-libfuzzer,
+// o main vem do libFuzzer). Sem, o executável roda os arquivos passados ou
+// faz mutações aleatórias a partir deles (veja imprimir_ajuda).
+
+#define FUZZ_QUADROS 120
+#define FUZZ_HZ 6000
+#define FUZZ_MAX_EVENTOS 32
+#define FUZZ_ENDERECO_ROM 0x200
+
+static const char* const fuzz_motores[] = { "interpretador", "cache", "blocos" };
+#define FUZZ_NUM_MOTORES (int)(sizeof(fuzz_motores) / sizeof(fuzz_motores[0]))
+
+struct ResultadoFuzz {
+    VM_Status status;
+    uint64_t quadros;
+    uint64_t hash;
+};
+
+static void fuzz_falha(const char* motivo, const char* motor) {
+    fprintf(stderr, "Falha do fuzzer: %s (motor %s)\n", motivo, motor);
+    abort();
+}
+
+// Estados que nenhuma instrução deve produzir
+static void fuzz_conferir(const VM& vm, uint32_t tam_ram, uint8_t quirks, const char* motor) {
+    if (vm.tam_ram != tam_ram) fuzz_falha("tam_ram mudou durante a execução", motor);
+    if (vm.quirks != quirks) fuzz_falha("perfil de quirks mudou durante a execução", motor);
+    if (vm.SP > 16) fuzz_falha("SP passou de 16", motor);
+    if (vm.hires > 1) fuzz_falha("modo de tela inválido", motor);
+    if (vm.planos >= 1 << VM_PLANOS) fuzz_falha("planos inválidos", motor);
+}
+
+static ResultadoFuzz fuzz_rodar(VM& vm, Motor& motor, const char* nome_motor, const uint8_t* ram, uint32_t tam_ram,
+                                uint8_t quirks, const std::vector<EventoEntrada>& eventos) {
+    vm.VM_Inicializar(FUZZ_ENDERECO_ROM, ram, tam_ram);
+    vm.VM_DefinirQuirks((VM_Quirks)quirks, NULL); // tam_ram já é o do perfil
+    motor.InvalidarTudo();
+
+    ResultadoFuzz r = { VM_OK, 0, 0 };
+    size_t prox_evento = 0;
+    for (; r.quadros < FUZZ_QUADROS; r.quadros++) {
+        Sessao_AplicarEntrada(vm, r.quadros, eventos, &prox_evento);
+        r.status = motor.Executar(vm, Sessao_CiclosQuadro(r.quadros, FUZZ_HZ));
+        fuzz_conferir(vm, tam_ram, quirks, nome_motor);
+        if (r.status != VM_OK) break;
+        vm.VM_ProcessarTimers();
+    }
+    r.hash = vm.VM_HashEstado();
+    return r;
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* dados, size_t tam) {
+    VM vms[FUZZ_NUM_MOTORES];
+    static Motor* motores[FUZZ_NUM_MOTORES];
+    static uint8_t ram[VM_TAM_RAM];
+    if (motores[0] == NULL) {
+        for (int m = 0; m < FUZZ_NUM_MOTORES; m++) motores[m] = Motor_Criar(fuzz_motores[m]);
+    }
+
+    size_t pos = 0;
+    uint8_t cabecalho = pos < tam ? dados[pos++] : 0;
+    uint8_t quirks = cabecalho % VM_NUM_QUIRKS;
+    int num_eventos = (pos < tam ? dados[pos++] : 0) % FUZZ_MAX_EVENTOS;
+
+    std::vector<EventoEntrada> eventos;
+    for (int e = 0; e < num_eventos && pos + 1 < tam; e++, pos += 2) {
+        EventoEntrada ev;
+        ev.quadro = dados[pos];
+        ev.tecla = dados[pos + 1] & 0xF;
+        ev.pressionada = (dados[pos + 1] >> 4) & 1;
+        eventos.push_back(ev);
+    }
+    std::stable_sort(eventos.begin(), eventos.end(),
+                     [](const EventoEntrada& a, const EventoEntrada& b) { return a.quadro < b.quadro; });
+
+    // RAM inicial como a de ROM_Carregar, já do tamanho do perfil: fontes
+    // e a ROM em 0x200
+    uint32_t tam_ram = VM_TamRAMQuirks((VM_Quirks)quirks);
+    size_t tam_rom = tam - pos;
+    if (tam_rom > tam_ram - FUZZ_ENDERECO_ROM) tam_rom = tam_ram - FUZZ_ENDERECO_ROM;
+    memcpy(ram, VM_RAMInicial(), VM_TAM_RAM_CHIP8);
+    memset(ram + VM_TAM_RAM_CHIP8, 0, VM_TAM_RAM - VM_TAM_RAM_CHIP8);
+    if (tam_rom) memcpy(ram + FUZZ_ENDERECO_ROM, dados + pos, tam_rom);
+
+    // Todos os motores têm que chegar no mesmo estado que o interpretador
+    ResultadoFuzz ref = fuzz_rodar(vms[0], *motores[0], fuzz_motores[0], ram, tam_ram, quirks, eventos);
+    for (int m = 1; m < FUZZ_NUM_MOTORES; m++) {
+        ResultadoFuzz r = fuzz_rodar(vms[m], *motores[m], fuzz_motores[m], ram, tam_ram, quirks, eventos);
+        if (r.status != ref.status || r.quadros != ref.quadros || r.hash != ref.hash) {
+            fprintf(stderr, "interpretador: %s no quadro %llu, hash %016llx\n", VM_DescreverStatus(ref.status),
+                    (unsigned long long)ref.quadros, (unsigned long long)ref.hash);
+            fprintf(stderr, "%s: %s no quadro %llu, hash %016llx\n", fuzz_motores[m], VM_DescreverStatus(r.status),
+                    (unsigned long long)r.quadros, (unsigned long long)r.hash);
+            fuzz_falha("estado final diferente do interpretador", fuzz_motores[m]);
+        }
+    }
+    return 0;
+}
+
+#ifndef C8_LIBFUZZER
+
+// Executável independente: sem cobertura (isso é o libFuzzer), mas com as
+// mesmas verificações. Roda cada arquivo uma vez (reproduzir uma falha ou
+// conferir um corpus) e, com --iteracoes, faz mutações aleatórias deles.
+
+#define FUZZ_ARQ_FALHA "fuzz-falha.bin"
+
+// Entrada em execução, gravada em FUZZ_ARQ_FALHA se o processo cair
+static std::vector<uint8_t> fuzz_atual;
+
+static void fuzz_gravar_atual() {
+    int fd = open(FUZZ_ARQ_FALHA, O_WRONLY | O_CREAT | O_TRUNC, 0644);
+    if (fd < 0) return;
+    if (!fuzz_atual.empty() && write(fd, fuzz_atual.data(), fuzz_atual.size()) < 0) {}
+    close(fd);
+}
+
+// Só funções seguras em sinal: grava a entrada e deixa o sinal seguir
+static void fuzz_sinal(int sinal) {
+    static const char travou[] = "Falha do fuzzer: entrada travou (tempo limite)\n";
+    static const char caiu[] = "Falha do fuzzer: entrada derrubou o processo, gravada em " FUZZ_ARQ_FALHA "\n";
+    if (sinal == SIGALRM && write(2, travou, sizeof(travou) - 1) < 0) {}
+    fuzz_gravar_atual();
+    if (write(2, caiu, sizeof(caiu) - 1) < 0) {}
+    signal(sinal == SIGALRM ? SIGABRT : sinal, SIG_DFL);
+    if (sinal == SIGALRM) abort();
+    raise(sinal);
+}
+
+static bool fuzz_ler(const char* caminho, std::vector<uint8_t>& dados) {
+    FILE* arq = fopen(caminho, "rb");
+    if (!arq) return false;
+    uint8_t buf[4096];
+    size_t n;
+    dados.clear();
+    while ((n = fread(buf, 1, sizeof(buf), arq)) > 0) dados.insert(dados.end(), buf, buf + n);
+    fclose(arq);
+    return true;
+}
+
+static void fuzz_listar(const char* caminho, std::vector<std::string>& arquivos) {
+    struct stat st;
+    if (stat(caminho, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        arquivos.push_back(caminho);
+        return;
+    }
+    DIR* dir = opendir(caminho);
+    if (!dir) return;
+    std::vector<std::string> nomes;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        std::string arquivo = std::string(caminho) + "/" + ent->d_name;
+        if (stat(arquivo.c_str(), &st) == 0 && S_ISREG(st.st_mode)) nomes.push_back(arquivo);
+    }
+    closedir(dir);
+    std::sort(nomes.begin(), nomes.end());
+    arquivos.insert(arquivos.end(), nomes.begin(), nomes.end());
+}
+
+static void fuzz_executar(const std::vector<uint8_t>& dados, unsigned tempo_limite) {
+    fuzz_atual = dados;
+    if (tempo_limite) alarm(tempo_limite);
+    LLVMFuzzerTestOneInput(dados.data(), dados.size());
+    if (tempo_limite) alarm(0);
+}
+
+// Mutações no estilo do libFuzzer, com preferência por instruções inteiras
+// (2 bytes alinhados na ROM), que têm mais chance de mudar o caminho
+static void fuzz_mutar(std::vector<uint8_t>& d, std::mt19937& rng) {
+    int n = 1 + rng() % 8;
+    for (int k = 0; k < n; k++) {
+        if (d.size() < 2) d.resize(2, 0);
+        size_t pos = rng() % d.size();
+        switch (rng() % 7) {
+            case 0: d[pos] ^= (uint8_t)(1 << (rng() % 8)); break;
+            case 1: d[pos] = (uint8_t)rng(); break;
+            case 2: { // Instrução aleatória em posição par da ROM
+                size_t p = 2 + ((rng() % d.size()) & ~(size_t)1);
+                if (p + 1 >= d.size()) d.resize(p + 2, 0);
+                uint16_t inst = (uint16_t)rng();
+                d[p] = inst >> 8;
+                d[p + 1] = inst & 0xFF;
+                break;
+            }
+            case 3: { // Trecho copiado de outro lugar
+                size_t de = rng() % d.size(), tam = 1 + rng() % 16;
+                if (de + tam > d.size()) tam = d.size() - de;
+                std::vector<uint8_t> trecho(d.begin() + de, d.begin() + de + tam);
+                d.insert(d.begin() + pos, trecho.begin(), trecho.end());
+                break;
+            }
+            case 4: { // Trecho removido
+                size_t tam = 1 + rng() % 16;
+                if (pos + tam > d.size()) tam = d.size() - pos;
+                if (d.size() - tam >= 2) d.erase(d.begin() + pos, d.begin() + pos + tam);
+                break;
+            }
+            case 5: d[0] = (uint8_t)rng(); break; // Perfil de quirks
+            default: d[pos] = (uint8_t)(rng() % 2 ? 0xFF : 0x00); break;
+        }
+        if (d.size() > VM_TAM_RAM) d.resize(VM_TAM_RAM);
+    }
+}
+
+static void imprimir_ajuda(const char* prog_name) {
+    fprintf(stderr, "Uso: %s [OPÇÕES] <arquivo ou diretório ...>\n\n", prog_name);
+    fprintf(stderr, "Roda cada entrada uma vez nos motores %s, %s e %s e\n", fuzz_motores[0], fuzz_motores[1], fuzz_motores[2]);
+    fprintf(stderr, "para (gravando-a em '" FUZZ_ARQ_FALHA "') se eles divergirem ou o processo cair.\n\n");
+    fprintf(stderr, "Opções:\n");
+    fprintf(stderr, "  --iteracoes <n>        Depois, faz n mutações aleatórias das entradas\n");
+    fprintf(stderr, "  --semente <numero>     Semente das mutações (padrão: 1)\n");
+    fprintf(stderr, "  --roms                 Os arquivos são ROMs, não entradas do fuzzer\n");
+    fprintf(stderr, "                         (recebem um cabeçalho sem eventos, perfil padrao)\n");
+    fprintf(stderr, "  --tempo-limite <seg>   Falha se uma entrada levar mais que isso (padrão: 10)\n");
+    fprintf(stderr, "  --ajuda                Mostra esta mensagem de ajuda\n");
+}
+
+int main(int argc, char** argv) {
+    uint64_t iteracoes = 0;
+    uint32_t semente = 1;
+    unsigned tempo_limite = 10;
+    bool roms = false;
+    std::vector<std::string> arquivos;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--ajuda") == 0) {
+            imprimir_ajuda(argv[0]);
+            return 0;
+        }
+        else if (strcmp(argv[i], "--iteracoes") == 0 && i + 1 < argc) iteracoes = strtoull(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--semente") == 0 && i + 1 < argc) semente = (uint32_t)strtoul(argv[++i], NULL, 0);
+        else if (strcmp(argv[i], "--tempo-limite") == 0 && i + 1 < argc) tempo_limite = (unsigned)atoi(argv[++i]);
+        else if (strcmp(argv[i], "--roms") == 0) roms = true;
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            imprimir_ajuda(argv[0]);
+            return 1;
+        }
+        else fuzz_listar(argv[i], arquivos);
+    }
+
+    signal(SIGSEGV, fuzz_sinal);
+    signal(SIGBUS, fuzz_sinal);
+    signal(SIGFPE, fuzz_sinal);
+    signal(SIGILL, fuzz_sinal);
+    signal(SIGABRT, fuzz_sinal);
+    signal(SIGALRM, fuzz_sinal);
+
+    std::vector<std::vector<uint8_t> > corpus;
+    for (size_t k = 0; k < arquivos.size(); k++) {
+        std::vector<uint8_t> dados;
+        if (!fuzz_ler(arquivos[k].c_str(), dados)) {
+            fprintf(stderr, "Erro: não foi possível ler '%s'\n", arquivos[k].c_str());
+            return 1;
+        }
+        if (roms) dados.insert(dados.begin(), 2, 0);
+        corpus.push_back(dados);
+    }
+    if (corpus.empty()) corpus.push_back(std::vector<uint8_t>(2, 0));
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    for (size_t k = 0; k < corpus.size(); k++) fuzz_executar(corpus[k], tempo_limite);
+
+    std::mt19937 rng(semente);
+    for (uint64_t it = 0; it < iteracoes; it++) {
+        std::vector<uint8_t> dados = corpus[rng() % corpus.size()];
+        fuzz_mutar(dados, rng);
+        fuzz_executar(dados, tempo_limite);
+    }
+
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+    uint64_t execucoes = corpus.size() + iteracoes;
+    printf("{\"execucoes\":%llu,\"segundos\":%.3f,\"execucoes_por_segundo\":%.0f,\"falhas\":0}\n",
+           (unsigned long long)execucoes, segundos, segundos > 0 ? execucoes / segundos : 0.0);
+    return 0;
+}
+
+#endif
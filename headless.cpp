@@ -0,0 +1,232 @@
+#include "c8vm.h"
+#include "c8motor.h"
+#include "bench.h"
+#include "lote.h"
+#include "sessao.h"
+#include "c8rom.h"
+#include "c8analise.h"
+#include "recompilador.h"
+#include "conformidade.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <sys/stat.h>
+#include <algorithm>
+#include <string>
+#include <vector>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Executável sem SDL para rodar ROMs em máquinas sem janela
+
+const int DEFAULT_CHIP8_HZ = 700;
+const char* DEFAULT_DIR_ROMS = "arquivos de teste";
+
+void imprimir_ajuda(char* prog_name) {
+    fprintf(stderr, "Uso: %s --benchmark <ciclos> [OPÇÕES] [rom ou diretório ...]\n", prog_name);
+    fprintf(stderr, "     %s --lote <manifesto> [OPÇÕES]\n", prog_name);
+    fprintf(stderr, "     %s --reproduzir <gravacao> [--motor <nome> | --perfil <prefixo>] <rom>\n", prog_name);
+    fprintf(stderr, "     %s --analisar <json|dot> [--quirks <perfil>] <rom>\n", prog_name);
+    fprintf(stderr, "     %s --recompilar <saida.cpp> [--quirks <perfil>] <rom ou diretório ...>\n", prog_name);
+    fprintf(stderr, "     %s --conformidade <esperado> [--gerar] [--roteiro <arq>] [OPÇÕES] [rom ou diretório ...]\n", prog_name);
+    fprintf(stderr, "     %s --diferencial <motor_a> <motor_b> [--roteiro <arq>] [--hz <numero>] [rom ou diretório ...]\n\n", prog_name);
+    fprintf(stderr, "Modos:\n");
+    fprintf(stderr, "  --benchmark <ciclos>  Roda cada ROM por <ciclos> instruções sem limitar a velocidade\n");
+    fprintf(stderr, "                        e imprime uma linha JSON por ROM (padrão: ROMs de '%s')\n", DEFAULT_DIR_ROMS);
+    fprintf(stderr, "                        Com --instancias <n>, roda n cópias de cada ROM em lock-step\n");
+    fprintf(stderr, "  --lote <manifesto>    Roda as sessões do manifesto em paralelo (uma por linha:\n");
+    fprintf(stderr, "                        <rom> <semente> <roteiro|-> <ciclos>) e imprime uma linha\n");
+    fprintf(stderr, "                        JSON por sessão com os hashes do estado final\n");
+    fprintf(stderr, "  --reproduzir <arq>    Reproduz na velocidade máxima uma gravação feita com\n");
+    fprintf(stderr, "                        'chip8 --gravar' e confere se o estado final é idêntico\n");
+    fprintf(stderr, "  --analisar <formato>  Desmonta a ROM sem executar e imprime o grafo de fluxo de\n");
+    fprintf(stderr, "                        controle, as regiões de código/dados e as escritas que podem\n");
+    fprintf(stderr, "                        modificar o código, em JSON ou DOT (Graphviz)\n");
+    fprintf(stderr, "  --recompilar <arq>    Gera um fonte C++ com uma função por bloco básico de cada ROM,\n");
+    fprintf(stderr, "                        para o motor 'aot' (veja 'make aot')\n");
+    fprintf(stderr, "  --conformidade <arq>  Roda cada ROM em todos os perfis de quirks com semente e entrada\n");
+    fprintf(stderr, "                        fixas e compara os hashes dos pontos de controle com os do\n");
+    fprintf(stderr, "                        arquivo (com --gerar, grava o arquivo). Usado por 'make test'\n");
+    fprintf(stderr, "  --diferencial <a> <b> Roda as mesmas sessões nos motores a e b lado a lado e mostra a\n");
+    fprintf(stderr, "                        primeira instrução em que os estados divergem\n");
+    fprintf(stderr, "\nOpções:\n");
+    fprintf(stderr, "  --motor <nome>        Motor de execução: %s (padrão: %s)\n", MOTORES_DISPONIVEIS, MOTOR_PADRAO);
+    fprintf(stderr, "  --quirks <perfil>     Compatibilidade: %s (padrão: padrao);\n", QUIRKS_DISPONIVEIS);
+    fprintf(stderr, "                        --reproduzir usa o da gravação\n");
+    fprintf(stderr, "  --hz <numero>         Ciclos por segundo emulado, define a cada quantos ciclos\n");
+    fprintf(stderr, "                        os timers andam (padrão: %d)\n", DEFAULT_CHIP8_HZ);
+    fprintf(stderr, "  --roteiro <arq>       Roteiro de entrada dos modos --conformidade e --diferencial\n");
+    fprintf(stderr, "                        ('<quadro> <tecla hex> <1|0>' por linha, como no --lote)\n");
+    fprintf(stderr, "  --threads <numero>    Threads do modo --lote (padrão: uma por núcleo)\n");
+    fprintf(stderr, "  --perfil <prefixo>    No modo --reproduzir, mede cada operação, PC e sub-rotina e\n");
+    fprintf(stderr, "                        grava <prefixo>.txt e <prefixo>.folded (flamegraph)\n");
+    fprintf(stderr, "  --ajuda               Mostra esta mensagem de ajuda\n");
+}
+
+// Expande diretórios para os arquivos dentro deles (em ordem alfabética)
+void listar_roms(const char* caminho, std::vector<std::string>& roms) {
+    struct stat st;
+    if (stat(caminho, &st) != 0 || !S_ISDIR(st.st_mode)) {
+        roms.push_back(caminho);
+        return;
+    }
+
+    DIR* dir = opendir(caminho);
+    if (!dir) return;
+
+    std::vector<std::string> nomes;
+    struct dirent* ent;
+    while ((ent = readdir(dir)) != NULL) {
+        if (ent->d_name[0] == '.') continue;
+        std::string arquivo = std::string(caminho) + "/" + ent->d_name;
+        if (stat(arquivo.c_str(), &st) == 0 && S_ISREG(st.st_mode)) nomes.push_back(arquivo);
+    }
+    closedir(dir);
+
+    std::sort(nomes.begin(), nomes.end());
+    roms.insert(roms.end(), nomes.begin(), nomes.end());
+}
+
+// Modo --analisar: análise estática de uma ROM (veja c8analise.h)
+int analisar(const char* formato, const std::vector<std::string>& roms, VM_Quirks quirks) {
+    bool json = strcmp(formato, "json") == 0;
+    if (!json && strcmp(formato, "dot") != 0) {
+        fprintf(stderr, "Erro: Formato de análise desconhecido '%s' (use: json, dot)\n", formato);
+        return 1;
+    }
+    if (roms.size() != 1) {
+        fprintf(stderr, "Erro: --analisar precisa de exatamente uma ROM\n");
+        return 1;
+    }
+
+    std::string erro;
+    const ImagemROM* img = ROM_Carregar(roms[0].c_str(), 0x200, &erro);
+    if (img == NULL || !VM_CabeNoPerfil(img->tam_ram, quirks, &erro)) {
+        fprintf(stderr, "Erro: ROM '%s': %s\n", roms[0].c_str(), erro.c_str());
+        return 1;
+    }
+
+    AnaliseROM analise;
+    Analise_ROM(*img, quirks, &analise);
+    if (json) Analise_EscreverJSON(analise, roms[0].c_str(), stdout);
+    else Analise_EscreverDOT(analise, roms[0].c_str(), stdout);
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    uint64_t ciclos_benchmark = 0;
+    const char* manifesto = NULL;
+    const char* gravacao = NULL;
+    const char* perfil = NULL;
+    const char* formato_analise = NULL;
+    const char* fonte_aot = NULL;
+    const char* esperado = NULL;
+    const char* roteiro = NULL;
+    const char* motor_diferencial = NULL;
+    bool gerar = false;
+    int threads = 0;
+    int instancias = 0;
+    int chip8_frequency = DEFAULT_CHIP8_HZ;
+    const char* nome_motor = MOTOR_PADRAO;
+    VM_Quirks quirks = VM_QUIRKS_PADRAO;
+    std::vector<std::string> roms;
+
+    for (int i = 1; i < argc; ++i) {
+        if (strcmp(argv[i], "--ajuda") == 0) {
+            imprimir_ajuda(argv[0]);
+            exit(EXIT_SUCCESS);
+        }
+        else if (strcmp(argv[i], "--benchmark") == 0 && i + 1 < argc) {
+            ciclos_benchmark = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--lote") == 0 && i + 1 < argc) {
+            manifesto = argv[++i];
+        }
+        else if (strcmp(argv[i], "--reproduzir") == 0 && i + 1 < argc) {
+            gravacao = argv[++i];
+        }
+        else if (strcmp(argv[i], "--analisar") == 0 && i + 1 < argc) {
+            formato_analise = argv[++i];
+        }
+        else if (strcmp(argv[i], "--recompilar") == 0 && i + 1 < argc) {
+            fonte_aot = argv[++i];
+        }
+        else if (strcmp(argv[i], "--conformidade") == 0 && i + 1 < argc) {
+            esperado = argv[++i];
+        }
+        else if (strcmp(argv[i], "--gerar") == 0) {
+            gerar = true;
+        }
+        else if (strcmp(argv[i], "--diferencial") == 0 && i + 2 < argc) {
+            nome_motor = argv[++i];
+            motor_diferencial = argv[++i];
+        }
+        else if (strcmp(argv[i], "--roteiro") == 0 && i + 1 < argc) {
+            roteiro = argv[++i];
+        }
+        else if (strcmp(argv[i], "--perfil") == 0 && i + 1 < argc) {
+            perfil = argv[++i];
+        }
+        else if (strcmp(argv[i], "--instancias") == 0 && i + 1 < argc) {
+            instancias = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--motor") == 0 && i + 1 < argc) {
+            nome_motor = argv[++i];
+        }
+        else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc) {
+            if (!VM_QuirksPorNome(argv[++i], &quirks)) {
+                fprintf(stderr, "Erro: Perfil de quirks desconhecido '%s' (use: %s)\n", argv[i], QUIRKS_DISPONIVEIS);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if (strcmp(argv[i], "--hz") == 0 && i + 1 < argc) {
+            chip8_frequency = atoi(argv[++i]);
+        }
+        else if (argv[i][0] == '-') {
+            fprintf(stderr, "Argumento desconhecido: %s\n", argv[i]);
+            imprimir_ajuda(argv[0]);
+            exit(EXIT_FAILURE);
+        }
+        else {
+            listar_roms(argv[i], roms);
+        }
+    }
+
+    if (gravacao != NULL) {
+        if (roms.size() != 1) {
+            fprintf(stderr, "Erro: --reproduzir precisa de exatamente uma ROM\n");
+            exit(EXIT_FAILURE);
+        }
+        return Sessao_Reproduzir(gravacao, roms[0].c_str(), nome_motor, perfil);
+    }
+
+    if (formato_analise != NULL) return analisar(formato_analise, roms, quirks);
+    if (fonte_aot != NULL) return Recompilador_Executar(fonte_aot, roms, quirks);
+
+    if (ciclos_benchmark == 0 && manifesto == NULL && esperado == NULL && motor_diferencial == NULL) {
+        imprimir_ajuda(argv[0]);
+        exit(EXIT_FAILURE);
+    }
+
+    if (chip8_frequency <= 0) {
+        fprintf(stderr, "Erro: Frequência deve ser > 0\n");
+        exit(EXIT_FAILURE);
+    }
+
+    if (esperado != NULL || motor_diferencial != NULL) {
+        if (roms.empty()) listar_roms(DEFAULT_DIR_ROMS, roms);
+        if (esperado != NULL) return Conformidade_Executar(esperado, gerar, roms, roteiro, nome_motor, chip8_frequency);
+        return Conformidade_Diferencial(nome_motor, motor_diferencial, roms, roteiro, chip8_frequency);
+    }
+
+    if (manifesto != NULL) return Lote_Executar(manifesto, nome_motor, chip8_frequency, threads, quirks);
+
+    if (roms.empty()) listar_roms(DEFAULT_DIR_ROMS, roms);
+
+    if (instancias > 0) return Bench_ExecutarGrupo(roms, ciclos_benchmark, instancias, chip8_frequency, quirks);
+    return Bench_Executar(roms, ciclos_benchmark, nome_motor, chip8_frequency, quirks);
+}
@@ -0,0 +1,242 @@
+#include "lote.h"
+#include "c8vm.h"
+#include "c8motor.h"
+#include "c8rom.h"
+#include "c8analise.h"
+#include "sessao.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <chrono>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+struct TrabalhoLote {
+    // Entrada (do manifesto)
+    std::string rom;
+    uint64_t semente;
+    std::string roteiro;          // Vazio = sem entrada
+    uint64_t ciclos;
+
+    // Saída
+    std::string erro;             // Não vazio = sessão não pôde rodar
+    ResultadoSessao resultado;
+    uint64_t hash_estado;
+    uint64_t hash_display;
+    double segundos;
+};
+
+std::vector<std::string> Lote_Campos(const char* linha) {
+    std::vector<std::string> campos;
+    const char* p = linha;
+    for (;;) {
+        while (*p == ' ' || *p == '\t' || *p == '\r' || *p == '\n') p++;
+        if (*p == '\0' || *p == '#') break;
+
+        std::string campo;
+        if (*p == '"') {
+            p++;
+            while (*p != '\0' && *p != '"') campo += *p++;
+            if (*p == '"') p++;
+        } else {
+            while (*p != '\0' && *p != ' ' && *p != '\t' && *p != '\r' && *p != '\n') campo += *p++;
+        }
+        campos.push_back(campo);
+    }
+    return campos;
+}
+
+static bool lote_ler_manifesto(const char* caminho, std::vector<TrabalhoLote>& trabalhos) {
+    FILE* arq = fopen(caminho, "r");
+    if (!arq) {
+        fprintf(stderr, "Erro: não foi possível abrir o manifesto '%s'\n", caminho);
+        return false;
+    }
+
+    char linha[4096];
+    int num_linha = 0;
+    while (fgets(linha, sizeof(linha), arq)) {
+        num_linha++;
+        std::vector<std::string> campos = Lote_Campos(linha);
+        if (campos.empty()) continue;
+
+        if (campos.size() != 4) {
+            fprintf(stderr, "Erro: %s:%d: esperado '<rom> <semente> <roteiro|-> <ciclos>'\n", caminho, num_linha);
+            fclose(arq);
+            return false;
+        }
+
+        TrabalhoLote t;
+        t.rom = campos[0];
+        t.semente = strtoull(campos[1].c_str(), NULL, 0);
+        t.roteiro = campos[2] == "-" ? "" : campos[2];
+        t.ciclos = strtoull(campos[3].c_str(), NULL, 0);
+        t.hash_estado = t.hash_display = 0;
+        t.segundos = 0;
+        trabalhos.push_back(t);
+    }
+    fclose(arq);
+    return true;
+}
+
+// Pool com roubo de trabalho: cada thread tem sua fila de índices, consome
+// do fim da própria fila e, quando ela esvazia, rouba do começo da fila de
+// outra thread. As filas só são tocadas uma vez por sessão, então um mutex
+// por fila não pesa perto do custo de rodar uma sessão.
+class PoolLote {
+public:
+    explicit PoolLote(int n) : filas(n) {}
+
+    void Distribuir(size_t total) {
+        for (size_t i = 0; i < total; i++) filas[i % filas.size()].itens.push_back(i);
+    }
+
+    bool Pegar(size_t dono, size_t* item) {
+        if (filas[dono].TirarDoFim(item)) return true;
+        for (size_t k = 1; k < filas.size(); k++) {
+            if (filas[(dono + k) % filas.size()].TirarDoComeco(item)) return true;
+        }
+        return false;
+    }
+
+private:
+    struct Fila {
+        std::mutex trava;
+        std::deque<size_t> itens;
+
+        bool TirarDoFim(size_t* item) {
+            std::lock_guard<std::mutex> g(trava);
+            if (itens.empty()) return false;
+            *item = itens.back();
+            itens.pop_back();
+            return true;
+        }
+
+        bool TirarDoComeco(size_t* item) {
+            std::lock_guard<std::mutex> g(trava);
+            if (itens.empty()) return false;
+            *item = itens.front();
+            itens.pop_front();
+            return true;
+        }
+    };
+
+    std::vector<Fila> filas;
+};
+
+// Análises das ROMs já rodadas por uma thread, pela imagem (que nunca muda)
+typedef std::map<const ImagemROM*, AnaliseROM> AnalisesLote;
+
+static void lote_rodar(TrabalhoLote& t, VM& vm, Motor& motor, int hz, VM_Quirks quirks, AnalisesLote& analises) {
+    std::vector<EventoEntrada> eventos;
+    if (!t.roteiro.empty() && !Sessao_LerRoteiro(t.roteiro.c_str(), eventos, &t.erro)) return;
+
+    // Sessões da mesma ROM dividem a imagem: cada uma só copia os tam_ram bytes
+    const ImagemROM* img = ROM_Carregar(t.rom.c_str(), 0x200, &t.erro);
+    if (img == NULL || !VM_CabeNoPerfil(img->tam_ram, quirks, &t.erro)) return;
+
+    // A análise é feita uma vez por ROM e por thread; cada sessão só
+    // preaquece o motor com ela
+    AnalisesLote::iterator it = analises.find(img);
+    if (it == analises.end()) {
+        it = analises.insert(std::make_pair(img, AnaliseROM())).first;
+        Analise_ROM(*img, quirks, &it->second);
+    }
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    vm.VM_Inicializar(img->pc_inicial, img->RAM.data(), img->tam_ram);
+    vm.VM_Semear(t.semente);
+    vm.VM_DefinirQuirks(quirks, NULL); // A ROM já foi conferida
+    motor.InvalidarTudo();
+    motor.Preaquecer(vm, it->second);
+    t.resultado = Sessao_Rodar(vm, motor, t.ciclos, hz, eventos);
+    t.segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    t.hash_estado = vm.VM_HashEstado();
+    t.hash_display = vm.VM_HashDisplay();
+}
+
+static void lote_trabalhador(PoolLote* pool, size_t id, std::vector<TrabalhoLote>* trabalhos,
+                             const char* nome_motor, int hz, VM_Quirks quirks) {
+    VM* vm = new VM();
+    Motor* motor = Motor_Criar(nome_motor);
+    AnalisesLote analises;
+
+    size_t i;
+    while (pool->Pegar(id, &i)) lote_rodar((*trabalhos)[i], *vm, *motor, hz, quirks, analises);
+
+    delete motor;
+    delete vm;
+}
+
+void Lote_JsonTexto(const std::string& s) {
+    putchar('"');
+    for (size_t i = 0; i < s.size(); i++) {
+        unsigned char c = s[i];
+        if (c == '"' || c == '\\') printf("\\%c", c);
+        else if (c < 0x20) printf("\\u%04x", c);
+        else putchar(c);
+    }
+    putchar('"');
+}
+
+int Lote_Executar(const char* manifesto, const char* nome_motor, int hz, int threads, VM_Quirks quirks) {
+    Motor* teste = Motor_Criar(nome_motor);
+    if (teste == NULL) {
+        fprintf(stderr, "Erro: Motor desconhecido '%s' (use: %s)\n", nome_motor, MOTORES_DISPONIVEIS);
+        return 1;
+    }
+    delete teste;
+
+    std::vector<TrabalhoLote> trabalhos;
+    if (!lote_ler_manifesto(manifesto, trabalhos)) return 1;
+
+    if (threads <= 0) threads = (int)std::thread::hardware_concurrency();
+    if (threads <= 0) threads = 1;
+    if ((size_t)threads > trabalhos.size() && !trabalhos.empty()) threads = (int)trabalhos.size();
+
+    PoolLote pool(threads);
+    pool.Distribuir(trabalhos.size());
+
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    std::vector<std::thread> ts;
+    for (int i = 0; i < threads; i++) {
+        ts.push_back(std::thread(lote_trabalhador, &pool, (size_t)i, &trabalhos, nome_motor, hz, quirks));
+    }
+    for (size_t i = 0; i < ts.size(); i++) ts[i].join();
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t total_ciclos = 0;
+    int erros = 0;
+    for (size_t i = 0; i < trabalhos.size(); i++) {
+        const TrabalhoLote& t = trabalhos[i];
+        printf("{\"sessao\":%zu,\"rom\":", i);
+        Lote_JsonTexto(t.rom);
+        printf(",\"semente\":%llu", (unsigned long long)t.semente);
+        if (!t.erro.empty()) {
+            printf(",\"erro\":");
+            Lote_JsonTexto(t.erro);
+            printf("}\n");
+            erros++;
+            continue;
+        }
+        printf(",\"status\":\"%s\",\"ciclos\":%llu,\"quadros\":%llu,\"segundos\":%.6f,"
+               "\"hash_estado\":\"%016llx\",\"hash_display\":\"%016llx\"}\n",
+               VM_DescreverStatus(t.resultado.status), (unsigned long long)t.resultado.ciclos,
+               (unsigned long long)t.resultado.quadros, t.segundos,
+               (unsigned long long)t.hash_estado, (unsigned long long)t.hash_display);
+        total_ciclos += t.resultado.ciclos;
+    }
+
+    printf("{\"sessoes\":%zu,\"erros\":%d,\"threads\":%d,\"motor\":\"%s\",\"ciclos\":%llu,"
+           "\"segundos\":%.6f,\"instrucoes_por_segundo\":%.0f}\n",
+           trabalhos.size(), erros, threads, nome_motor, (unsigned long long)total_ciclos,
+           segundos, segundos > 0 ? total_ciclos / segundos : 0.0);
+    return 0;
+}
@@ -0,0 +1,29 @@
+#ifndef LOTE_H
+#define LOTE_H
+
+#include <string>
+#include <vector>
+#include "c8vm.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Execução em lote: lê um manifesto com uma sessão por linha
+//
+//     <rom> <semente> <roteiro de entrada | -> <ciclos>
+//
+// (caminhos com espaço vão entre aspas; '#' inicia um comentário) e roda
+// todas as sessões sem janela em 'threads' threads (0 = uma por núcleo),
+// com roubo de trabalho entre elas. Imprime uma linha JSON por sessão, na
+// ordem do manifesto, com os hashes do estado final e as estatísticas.
+// Todas as sessões usam o perfil de quirks 'quirks'. Retorna != 0 se o
+// manifesto não pôde ser lido.
+int Lote_Executar(const char* manifesto, const char* nome_motor, int hz, int threads, VM_Quirks quirks);
+
+// Separa a linha em campos por espaço; "..." agrupa um campo com espaços e
+// '#' encerra a linha (também usado pelos arquivos de conformidade.h)
+std::vector<std::string> Lote_Campos(const char* linha);
+
+// Escreve s em stdout entre aspas, escapando o que o JSON exige
+void Lote_JsonTexto(const std::string& s);
+
+#endif
@@ -1,8 +1,23 @@
 #include "c8vm.h"
+#include "c8motor.h"
+#include "c8rom.h"
+#include "c8analise.h"
+#include "c8perfil.h"
+#include "c8estado.h"
+#include "c8historico.h"
+#include "c8gravacao.h"
+#include "c8som.h"
+#include "c8fila.h"
 #include "defs.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
+#include <time.h>
+#include <string>
+#include <atomic>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
 #include <SDL2/SDL.h>
 
 //Autores: Guilherme Inoe, Winicius Abilio
@@ -12,6 +27,11 @@ const int DEFAULT_CHIP8_HZ = 700;
 const int DEFAULT_SCALE = 10;
 const uint16_t DEFAULT_PC_START = 0x200;
 const int TIMER_FREQUENCY = 60; // 60Hz fixo
+const int MAX_QUADROS_ATRASADOS = 5; // Quadros recuperados de uma vez antes de ressincronizar
+const int SEGUNDOS_HISTORICO = 300; // Quanto tempo dá para voltar segurando Backspace
+const int DEFAULT_BUFFER_AUDIO = 256; // Amostras por callback: ~5.8 ms a 44100 Hz
+const int TAXA_AUDIO = 44100;
+const int MAX_MS_OCIOSO = 250; // Maior espera por um evento com a VM parada (atualiza o título)
 
 // Mapeamento de teclas SDL para CHIP-8 (0-F)
 uint8_t key_map[SDL_NUM_SCANCODES] = {0};
@@ -39,57 +59,349 @@ void inicializar_key_map() {
 }
 
 
+// Escalonador de passo fixo. Os prazos dos quadros de 60Hz são absolutos
+// (inicio + quadro / 60 s, medidos com SDL_GetPerformanceCounter), então o
+// tempo gasto emulando/desenhando e o arredondamento do SDL_Delay não se
+// acumulam. A parte fracionária de hz / 60 é distribuída entre os quadros
+// em aritmética inteira, igual ao chip8_headless (sessao.h): com --hz 700
+// são exatamente 700 ciclos a cada 60 quadros e uma gravação de entrada
+// reproduz os mesmos ciclos em cada quadro.
+struct Escalonador {
+    Uint64 freq;              // Ticks do contador por segundo
+    Uint64 inicio;            // Valor do contador no quadro 0
+    uint64_t quadro;          // Próximo quadro a emular desde a última ressincronização
+    uint64_t emulados;        // Quadros emulados desde o início
+    uint64_t hz;
+
+    void Iniciar(int hz, Uint64 agora) {
+        this->freq = SDL_GetPerformanceFrequency();
+        this->hz = hz;
+        this->emulados = 0;
+        this->Ressincronizar(agora);
+    }
+
+    // Descarta o atraso acumulado: o próximo quadro vence agora
+    void Ressincronizar(Uint64 agora) {
+        this->inicio = agora;
+        this->quadro = 0;
+    }
+
+    Uint64 PrazoProximoQuadro() const {
+        return this->inicio + this->quadro * this->freq / TIMER_FREQUENCY;
+    }
+
+    // Avança um quadro e retorna quantos ciclos ele deve executar
+    uint64_t ProximoQuadro() {
+        uint64_t q = this->emulados++;
+        this->quadro++;
+        return (q + 1) * this->hz / TIMER_FREQUENCY - q * this->hz / TIMER_FREQUENCY;
+    }
+};
+
+
+// Roda na thread de áudio do SDL: só conversa com a emulação pela fila do SomVM
 void audio_callback(void* userdata, Uint8* stream, int len) {
-    VM* vm = (VM*)userdata;
-    Sint16* buffer = (Sint16*)stream;
-    int samples = len / (sizeof(Sint16)); // 2 bytes por amostra (Sint16)
-
-    // Período da onda (quantas amostras por ciclo de onda)
-    static const int TONE_PERIOD = 44100 / 440; 
-    static const Sint16 TONE_VOLUME = 3000;
-    static int wave_pos = 0; // Posição atual na onda
-
-    for (int i = 0; i < samples; i++) {
-        if (vm->sound_timer > 0) {
-            // Gera uma onda quadrada simples
-            buffer[i] = ((wave_pos++ / (TONE_PERIOD / 2)) % 2) ? TONE_VOLUME : -TONE_VOLUME;
-        } else {
-            buffer[i] = 0; // Silêncio
+    SomVM* som = (SomVM*)userdata;
+    som->Gerar((int16_t*)stream, len / (int)sizeof(Sint16)); // Mono, Sint16
+}
+
+
+// Cores dos pixels na textura (ARGB8888)
+// Cor de cada combinação dos planos (bit 0 = plano 1, bit 1 = plano 2)
+const Uint32 CORES[4] = {
+    0xFF000000, // Preto (apagado)
+    0xFFFFFFFF, // Branco (plano 1, o único no CHIP-8/SUPER-CHIP)
+    0xFFAAAAAA, // Cinza claro (plano 2)
+    0xFF555555  // Cinza escuro (os dois)
+};
+
+void desenhar_display(SDL_Renderer* renderer, SDL_Texture* textura,
+                      const uint64_t display[VM_PLANOS][VM_PALAVRAS_TELA], bool hires) {
+    // Copia a tela para a textura de 128x64 (a textura inteira é reescrita,
+    // já que o conteúdo de um SDL_LockTexture não é garantido). Em baixa
+    // resolução cada pixel vira um bloco 2x2.
+    void* pixels;
+    int pitch;
+    if (SDL_LockTexture(textura, NULL, &pixels, &pitch) == 0) {
+        for (int y = 0; y < 64; y++) {
+            Uint32* linha = (Uint32*)((Uint8*)pixels + y * pitch);
+            for (int x = 0; x < 128; x++) {
+                int palavra = hires ? 2 * y + x / 64 : y / 2;
+                int bit = hires ? 63 - x % 64 : 63 - x / 2;
+                int cor = ((display[0][palavra] >> bit) & 1) | (((display[1][palavra] >> bit) & 1) << 1);
+                linha[x] = CORES[cor];
+            }
         }
+        SDL_UnlockTexture(textura);
     }
+
+    // A textura é esticada para o tamanho da janela em uma única cópia
+    SDL_RenderCopy(renderer, textura, NULL, NULL);
+    SDL_RenderPresent(renderer);
 }
 
 
-void desenhar_display(SDL_Renderer* renderer, VM* vm, int pixel_size) {
-    //Define a cor de fundo (preto) e limpa a tela
-    SDL_SetRenderDrawColor(renderer, 0, 0, 0, 255);
-    SDL_RenderClear(renderer);
+// Aplica uma tecla na VM e, se estiver gravando, registra a mudança no
+// quadro que vai ser emulado em seguida (repetições do SDL não mudam nada)
+void processar_tecla(VM* vm, Gravacao* gravacao, uint64_t quadro, uint8_t tecla, bool apertada) {
+    if (gravacao != NULL && vm->KEY[tecla] != (apertada ? 1 : 0)) {
+        EventoEntrada ev;
+        ev.quadro = (uint32_t)quadro;
+        ev.tecla = tecla;
+        ev.pressionada = apertada ? 1 : 0;
+        gravacao->eventos.push_back(ev);
+    }
+    vm->VM_ProcessarInput(tecla, apertada);
+}
 
-    // Define a cor do pixel (branco)
-    SDL_SetRenderDrawColor(renderer, 255, 255, 255, 255);
-    
-    // Itera por cada pixel do display 64x32
-    for (int y = 0; y < 32; y++) {
-        for (int x = 0; x < 64; x++) {
-            
-            // Se o pixel (na VM) estiver aceso
-            if (vm->DISPLAY[y * 64 + x]) {
-                
-                // Define um retângulo escalado na posição correta
-                SDL_Rect pixel;
-                pixel.x = x * pixel_size;
-                pixel.y = y * pixel_size;
-                pixel.w = pixel_size;
-                pixel.h = pixel_size;
-                
-                // Desenha o retângulo (pixel)
-                SDL_RenderFillRect(renderer, &pixel);
+
+// A emulação roda em uma thread própria, no relógio do Escalonador; a
+// thread principal (a única que pode mexer na janela e nos eventos do SDL)
+// só lê o teclado e desenha. Elas conversam sem trava:
+//   janela -> emulação: Comandos por uma FilaSPSC
+//   emulação -> janela: a tela pronta por um BufferTriplo, avisando com um
+//                       evento do SDL que há quadro novo
+// Assim um SDL_RenderPresent lento (vsync, compositor) não atrasa a
+// emulação: ela sempre tem um buffer livre e a janela pega o último.
+
+enum TipoComando {
+    CMD_TECLA,            // Tecla do CHIP-8 (tecla, apertada)
+    CMD_VOLTAR,           // Backspace (apertada = segurando)
+    CMD_SALVAR_ESTADO,    // F5
+    CMD_CARREGAR_ESTADO   // F9
+};
+
+struct Comando {
+    uint8_t tipo;
+    uint8_t tecla;
+    uint8_t apertada;
+};
+
+// Quadro publicado pela emulação
+struct QuadroTela {
+    uint64_t DISPLAY[VM_PLANOS][VM_PALAVRAS_TELA];
+    bool hires;
+    uint32_t medicao;     // Muda a cada nova medição abaixo (atualiza o título)
+    double hz_medido;
+    double ms_quadro;     // Tempo gasto emulando por quadro
+};
+
+// Acorda a thread de emulação quando chega um comando, para ela não
+// esperar o próximo quadro (nem dormir indefinidamente quando ociosa)
+class Despertador {
+public:
+    Despertador() : avisado(false) {}
+
+    void Avisar() {
+        {
+            std::lock_guard<std::mutex> g(this->trava);
+            this->avisado = true;
+        }
+        this->cond.notify_one();
+    }
+
+    void Esperar(int ms) {
+        std::unique_lock<std::mutex> l(this->trava);
+        this->cond.wait_for(l, std::chrono::milliseconds(ms), [this] { return this->avisado; });
+        this->avisado = false;
+    }
+
+private:
+    std::mutex trava;
+    std::condition_variable cond;
+    bool avisado;
+};
+
+struct Emulacao {
+    // Só a thread de emulação mexe (depois que ela começa)
+    VM vm;
+    Motor* motor;
+    HistoricoVM* historico;
+    Gravacao* gravando;     // NULL sem --gravar
+    SomVM* som;
+    int hz;
+    std::string arquivo_estado;
+
+    // Compartilhados
+    FilaSPSC<Comando, 256> comandos;
+    BufferTriplo<QuadroTela> tela;
+    Despertador despertador;
+    std::atomic<bool> sair;
+    std::atomic<bool> quadro_avisado; // Já há um evento de quadro novo na fila do SDL
+    Uint32 evento_quadro;
+
+    Emulacao() : motor(NULL), historico(NULL), gravando(NULL), som(NULL), hz(0),
+                 sair(false), quadro_avisado(false), evento_quadro(0) {}
+};
+
+// Trata um comando da janela
+void executar_comando(Emulacao* em, const Comando& cmd, uint64_t quadro, bool* voltando) {
+    VM& vm = em->vm;
+    if (cmd.tipo == CMD_TECLA) {
+        processar_tecla(&vm, em->gravando, quadro, cmd.tecla, cmd.apertada != 0);
+    } else if (cmd.tipo == CMD_VOLTAR) {
+        *voltando = cmd.apertada && em->gravando == NULL;
+    } else if (cmd.tipo == CMD_CARREGAR_ESTADO && em->gravando != NULL) {
+        fprintf(stderr, "Aviso: carregar estado fica desligado durante a gravação\n");
+    } else {
+        std::string erro;
+        bool salvar = cmd.tipo == CMD_SALVAR_ESTADO;
+        bool ok = salvar ? Estado_SalvarArquivo(vm, em->arquivo_estado.c_str(), &erro)
+                         : Estado_CarregarArquivo(vm, em->arquivo_estado.c_str(), &erro);
+        if (!ok) {
+            fprintf(stderr, "Erro: estado '%s': %s\n", em->arquivo_estado.c_str(), erro.c_str());
+        } else if (!salvar) {
+            em->motor->InvalidarTudo(); // A RAM mudou por fora do motor
+        }
+    }
+}
+
+void emular(Emulacao* em) {
+    VM& vm = em->vm;
+    Motor* motor = em->motor;
+    bool voltando = false;
+    bool publicar = true; // O primeiro quadro sempre vai para a janela
+
+    Escalonador escalonador;
+    escalonador.Iniciar(em->hz, SDL_GetPerformanceCounter());
+
+    // Medições mostradas no título da janela a cada segundo
+    Uint64 inicio_medicao = SDL_GetPerformanceCounter();
+    uint64_t ciclos_medidos = 0;
+    uint64_t quadros_medidos = 0;
+    Uint64 ticks_ocupados = 0; // Tempo gasto emulando
+    uint32_t medicao = 0;
+    double hz_medido = 0, ms_quadro = 0;
+
+    while (!em->sair.load(std::memory_order_relaxed)) {
+        Comando cmd;
+        while (em->comandos.Tirar(&cmd)) executar_comando(em, cmd, escalonador.emulados, &voltando);
+
+        Uint64 agora = SDL_GetPerformanceCounter();
+
+        // Emula todos os quadros de 60Hz que já venceram. Timers andam um
+        // passo por quadro emulado, independente de quantas vezes desenhamos.
+        int quadros = 0;
+        bool falhou = false;
+        while (!falhou && agora >= escalonador.PrazoProximoQuadro()) {
+            if (quadros == MAX_QUADROS_ATRASADOS) {
+                // Muito atrasado (ex: máquina sobrecarregada): não tenta recuperar
+                escalonador.Ressincronizar(agora);
+                break;
+            }
+
+            uint64_t ciclos = escalonador.ProximoQuadro();
+
+            if (voltando) {
+                // Volta um quadro em vez de emular. O teclado continua
+                // refletindo as teclas apertadas agora, não as do passado.
+                uint8_t teclas[CHIP8_KEYS];
+                memcpy(teclas, vm.KEY, sizeof(teclas));
+                if (em->historico->Voltar(vm)) motor->InvalidarTudo();
+                memcpy(vm.KEY, teclas, sizeof(teclas));
+                em->som->Quadro(escalonador.emulados - 1, false);
+                quadros++;
+                continue;
+            }
+
+            //Executa os ciclos da CPU deste quadro. O som do quadro é o
+            // sound_timer antes do tick: um FX18 com 1 ainda toca um quadro.
+            VM_Status status = motor->Executar(vm, ciclos);
+            em->som->Quadro(escalonador.emulados - 1, status == VM_OK && vm.sound_timer > 0);
+            if (status == VM_PROGRAMA_ENCERRADO) {
+                // 00FD: a ROM pediu para sair
+                fprintf(stderr, "%s\n", VM_DescreverStatus(status));
+                falhou = true;
+            } else if (status != VM_OK) {
+                fprintf(stderr, "ERRO: %s (0x%04X em 0x%03X)\n", VM_DescreverStatus(status),
+                        (vm.RAM[vm.PC & (vm.tam_ram - 1)] << 8) | vm.RAM[(vm.PC + 1) & (vm.tam_ram - 1)], vm.PC);
+                vm.VM_ImprimirRegistradores();
+                #ifdef DEBUG
+                vm.VM_ImprimirRastro();
+                #endif
+                falhou = true;
+            } else {
+                //Processa timers a 60Hz
+                vm.VM_ProcessarTimers();
+                em->historico->Gravar(vm);
+            }
+
+            if (em->gravando) {
+                em->gravando->quadros = (uint32_t)escalonador.emulados;
+                em->gravando->hash_final = vm.VM_HashEstado();
+            }
+
+            ciclos_medidos += ciclos;
+            quadros++;
+        }
+        quadros_medidos += quadros;
+
+        Uint64 depois = SDL_GetPerformanceCounter();
+        ticks_ocupados += depois - agora;
+
+        // Mede a frequência e o tempo por quadro a cada segundo
+        if (depois - inicio_medicao >= escalonador.freq) {
+            double segundos = (double)(depois - inicio_medicao) / escalonador.freq;
+            hz_medido = ciclos_medidos / segundos;
+            ms_quadro = quadros_medidos ? 1000.0 * ticks_ocupados / escalonador.freq / quadros_medidos : 0;
+            medicao++;
+            publicar = true;
+
+            inicio_medicao = depois;
+            ciclos_medidos = quadros_medidos = 0;
+            ticks_ocupados = 0;
+        }
+
+        // Publica a tela se ela mudou (ou se há medição nova) e avisa a
+        // janela, a não ser que o aviso anterior ainda não tenha sido lido
+        if (vm.linhas_alteradas != 0 || publicar) {
+            QuadroTela& q = em->tela.Escrita();
+            memcpy(q.DISPLAY, vm.DISPLAY, sizeof(q.DISPLAY));
+            q.hires = vm.hires != 0;
+            q.medicao = medicao;
+            q.hz_medido = hz_medido;
+            q.ms_quadro = ms_quadro;
+            em->tela.Publicar();
+            vm.linhas_alteradas = 0;
+            publicar = false;
+
+            if (!em->quadro_avisado.exchange(true)) {
+                SDL_Event ev;
+                SDL_memset(&ev, 0, sizeof(ev));
+                ev.type = em->evento_quadro;
+                SDL_PushEvent(&ev);
+            }
+        }
+
+        if (falhou) {
+            // Fecha a janela; a thread principal termina o resto
+            em->sair = true;
+            SDL_Event ev;
+            SDL_memset(&ev, 0, sizeof(ev));
+            ev.type = SDL_QUIT;
+            SDL_PushEvent(&ev);
+            break;
+        }
+
+        // Dorme até o próximo quadro ou até chegar um comando (em ms
+        // inteiros; o resto do tempo é absorvido pelo prazo absoluto, então
+        // não há deriva acumulada)
+        Uint64 prazo = escalonador.PrazoProximoQuadro();
+        if (prazo > depois) {
+            int ms = (int)((prazo - depois) * 1000 / escalonador.freq);
+            VM_Espera espera = voltando ? VM_ESPERA_NENHUMA : vm.VM_EmEspera();
+
+            if (espera == VM_ESPERA_ENTRADA && vm.delay_timer == 0 && vm.sound_timer == 0) {
+                // Nada muda até chegar uma tecla (ex: menu esperando FX0A):
+                // os quadros seguintes seriam todos iguais, então dorme até
+                // o próximo comando e retoma dali, sem emular os quadros vazios
+                em->despertador.Esperar(MAX_MS_OCIOSO);
+                escalonador.Ressincronizar(SDL_GetPerformanceCounter());
+            } else {
+                em->despertador.Esperar(ms);
             }
         }
     }
-    
-    // Apresenta o quadro renderizado na janela
-    SDL_RenderPresent(renderer);
 }
 
 
@@ -99,6 +411,13 @@ void imprimir_ajuda(char* prog_name) {
     fprintf(stderr, "  --hz <numero>      Define a velocidade da CPU em Hz (padrão: %d)\n", DEFAULT_CHIP8_HZ);
     fprintf(stderr, "  --escala <numero>  Define o fator de escala da janela (padrão: %d)\n", DEFAULT_SCALE);
     fprintf(stderr, "  --pc <endereco>    Define o endereço de carga (padrão: 0x%X)\n", DEFAULT_PC_START);
+    fprintf(stderr, "  --motor <nome>     Motor de execução: %s (padrão: %s)\n", MOTORES_DISPONIVEIS, MOTOR_PADRAO);
+    fprintf(stderr, "  --quirks <perfil>  Compatibilidade: %s (padrão: padrao)\n", QUIRKS_DISPONIVEIS);
+    fprintf(stderr, "  --buffer-audio <n> Amostras por buffer de áudio; menor = menos latência (padrão: %d)\n", DEFAULT_BUFFER_AUDIO);
+    fprintf(stderr, "  --semente <numero> Semente do gerador do CXNN (padrão: a partir do relógio)\n");
+    fprintf(stderr, "  --gravar <arquivo> Grava a entrada da sessão para 'chip8_headless --reproduzir'\n");
+    fprintf(stderr, "  --perfil <prefixo> Mede cada operação, PC e sub-rotina; ao sair grava o relatório\n");
+    fprintf(stderr, "                     em <prefixo>.txt e as pilhas em <prefixo>.folded (flamegraph)\n");
     fprintf(stderr, "  --ajuda            Mostra esta mensagem de ajuda\n");
 }
 
@@ -112,6 +431,12 @@ int main(int argc, char** argv){
     int pixel_size = DEFAULT_SCALE;
     uint16_t pc_start = DEFAULT_PC_START;
     char* rom_path = NULL;
+    const char* nome_motor = MOTOR_PADRAO;
+    VM_Quirks quirks = VM_QUIRKS_PADRAO;
+    uint64_t semente = (uint64_t)time(NULL);
+    const char* arquivo_gravacao = NULL;
+    const char* prefixo_perfil = NULL;
+    int buffer_audio = DEFAULT_BUFFER_AUDIO;
 
     for (int i = 1; i < argc; ++i) {
         if (strcmp(argv[i], "--ajuda") == 0) {
@@ -127,6 +452,27 @@ int main(int argc, char** argv){
         else if (strcmp(argv[i], "--pc") == 0 && i + 1 < argc) { 
             pc_start = (uint16_t)strtol(argv[++i], NULL, 0);
         }
+        else if (strcmp(argv[i], "--motor") == 0 && i + 1 < argc) {
+            nome_motor = argv[++i];
+        }
+        else if (strcmp(argv[i], "--quirks") == 0 && i + 1 < argc) {
+            if (!VM_QuirksPorNome(argv[++i], &quirks)) {
+                fprintf(stderr, "Erro: Perfil de quirks desconhecido '%s' (use: %s)\n", argv[i], QUIRKS_DISPONIVEIS);
+                exit(EXIT_FAILURE);
+            }
+        }
+        else if ((strcmp(argv[i], "--semente") == 0 || strcmp(argv[i], "--seed") == 0) && i + 1 < argc) {
+            semente = strtoull(argv[++i], NULL, 0);
+        }
+        else if (strcmp(argv[i], "--buffer-audio") == 0 && i + 1 < argc) {
+            buffer_audio = atoi(argv[++i]);
+        }
+        else if (strcmp(argv[i], "--perfil") == 0 && i + 1 < argc) {
+            prefixo_perfil = argv[++i];
+        }
+        else if (strcmp(argv[i], "--gravar") == 0 && i + 1 < argc) {
+            arquivo_gravacao = argv[++i];
+        }
         else if (rom_path == NULL) {
             // O primeiro argumento que não é flag é a ROM
             rom_path = argv[i];
@@ -144,8 +490,16 @@ int main(int argc, char** argv){
         exit(EXIT_FAILURE);
     }
     
-    if (chip8_frequency <= 0 || pixel_size <= 0) {
-        fprintf(stderr, "Erro: Frequência e escala devem ser > 0\n");
+    if (chip8_frequency <= 0 || pixel_size <= 0 || buffer_audio <= 0 || buffer_audio > 65535) {
+        fprintf(stderr, "Erro: Frequência, escala e buffer de áudio devem ser > 0\n");
+        exit(EXIT_FAILURE);
+    }
+
+    // O perfil substitui o motor escolhido (executa como o interpretador)
+    MotorPerfil* perfil = prefixo_perfil ? new MotorPerfil() : NULL;
+    Motor* motor = perfil ? perfil : Motor_Criar(nome_motor);
+    if (motor == NULL) {
+        fprintf(stderr, "Erro: Motor desconhecido '%s' (use: %s)\n", nome_motor, MOTORES_DISPONIVEIS);
         exit(EXIT_FAILURE);
     }
 
@@ -153,9 +507,45 @@ int main(int argc, char** argv){
     int screen_width = 64 * pixel_size;
     int screen_height = 32 * pixel_size;
 
-    VM vm;
+    Emulacao em;
+    VM& vm = em.vm;
     vm.VM_Inicializar(pc_start);
-    vm.VM_CarregarROM(rom_path, pc_start);
+    vm.VM_DefinirQuirks(quirks, NULL); // A VM recém-inicializada cabe em qualquer perfil
+    std::string erro_rom;
+    if (!vm.VM_CarregarROM(rom_path, pc_start, &erro_rom)) {
+        fprintf(stderr, "Erro: ROM '%s': %s\n", rom_path, erro_rom.c_str());
+        exit(EXIT_FAILURE);
+    }
+    vm.VM_Semear(semente);
+    fprintf(stderr, "Semente: %llu\n", (unsigned long long)semente);
+
+    // Decodifica/traduz de antemão o código alcançável da ROM, para os
+    // primeiros quadros não pagarem a tradução (a imagem já está no cache)
+    const ImagemROM* img = ROM_Carregar(rom_path, pc_start, NULL);
+    if (img != NULL) {
+        AnaliseROM analise;
+        Analise_ROM(*img, quirks, &analise);
+        motor->Preaquecer(vm, analise);
+    }
+
+    // Com --gravar, a entrada de cada quadro é guardada e salva na saída.
+    // Voltar no tempo e carregar estado ficam desligados: a gravação só
+    // reproduz uma execução contínua a partir do início.
+    Gravacao gravacao;
+    Gravacao* gravando = NULL;
+    if (arquivo_gravacao != NULL) {
+        gravacao.semente = semente;
+        gravacao.hz = chip8_frequency;
+        gravacao.pc_inicial = pc_start;
+        gravacao.quirks = quirks;
+        gravacao.hash_inicial = vm.VM_HashEstado();
+        gravacao.quadros = 0;
+        gravacao.hash_final = gravacao.hash_inicial;
+        gravando = &gravacao;
+    }
+    #ifdef DEBUG
+    vm.rastro_ativo = true;
+    #endif
     inicializar_key_map();
 
     // Inicializa Vídeo e Áudio
@@ -164,21 +554,24 @@ int main(int argc, char** argv){
         exit(EXIT_FAILURE);
     }
 
-    // Configuração do Áudio
+    // Configuração do Áudio. Sem permitir mudanças: o SDL converte para o
+    // formato da placa se preciso, e o SomVM gera sempre na TAXA_AUDIO.
+    SomVM som(TAXA_AUDIO);
     SDL_AudioSpec want, have;
     SDL_memset(&want, 0, sizeof(want)); // Limpa a struct
-    want.freq = 44100;                 // Frequência (samples por seg)
+    want.freq = TAXA_AUDIO;            // Frequência (samples por seg)
     want.format = AUDIO_S16SYS;        // Formato (Signed 16-bit)
     want.channels = 1;                 // Mono
-    want.samples = 2048;               // Tamanho do buffer
+    want.samples = (Uint16)buffer_audio; // Tamanho do buffer (latência)
     want.callback = audio_callback;    // Função a ser chamada
-    want.userdata = &vm;               // Passa a VM para o callback
+    want.userdata = &som;              // A thread de áudio só vê o SomVM
 
-    if (SDL_OpenAudio(&want, &have) < 0) {
+    SDL_AudioDeviceID audio = SDL_OpenAudioDevice(NULL, 0, &want, &have, 0);
+    if (audio == 0) {
         fprintf(stderr, "Erro ao abrir áudio SDL: %s\n", SDL_GetError());
         // Continua o código se o áudio falhar
     } else {
-        SDL_PauseAudio(0); // Inicia a reprodução
+        SDL_PauseAudioDevice(audio, 0); // Inicia a reprodução
     }
 
     SDL_Window* window = SDL_CreateWindow(
@@ -189,64 +582,129 @@ int main(int argc, char** argv){
     );
 
     SDL_Renderer* renderer = SDL_CreateRenderer(window, -1, SDL_RENDERER_ACCELERATED);
+
+    // Textura do tamanho da tela de alta resolução, ampliada sem suavização
+    SDL_SetHint(SDL_HINT_RENDER_SCALE_QUALITY, "0");
+    SDL_Texture* textura = renderer ? SDL_CreateTexture(renderer, SDL_PIXELFORMAT_ARGB8888,
+                                                        SDL_TEXTUREACCESS_STREAMING, 128, 64) : NULL;
     
-    if (!window || !renderer) {
+    if (!window || !renderer || !textura) {
         fprintf(stderr, "Erro ao criar janela/renderizador SDL: %s\n", SDL_GetError());
         SDL_Quit();
         exit(EXIT_FAILURE);
     }
 
-    SDL_Event e;
-    int running = 1;
+    // F5 salva e F9 carrega o estado da VM neste arquivo
+    em.arquivo_estado = std::string(rom_path) + ".estado";
+
+    // Um estado por quadro emulado; segurar Backspace volta um quadro por quadro
+    HistoricoVM historico(SEGUNDOS_HISTORICO * TIMER_FREQUENCY);
 
-    // Ciclos de CPU por quadro de 60Hz
-    int cycles_per_frame = chip8_frequency / TIMER_FREQUENCY;
+    em.motor = motor;
+    em.historico = &historico;
+    em.gravando = gravando;
+    em.som = &som;
+    em.hz = chip8_frequency;
+    em.evento_quadro = SDL_RegisterEvents(1);
+    if (em.evento_quadro == (Uint32)-1) {
+        fprintf(stderr, "Erro ao registrar evento SDL: %s\n", SDL_GetError());
+        SDL_Quit();
+        exit(EXIT_FAILURE);
+    }
 
-    // Tempo por quadro (em ms) para atingir 60Hz
-    Uint32 timer_delay_ms = 1000 / TIMER_FREQUENCY;
+    // Daqui em diante a VM é da thread de emulação
+    std::thread emulacao(emular, &em);
+
+    SDL_Event e;
+    int running = 1;
+    uint32_t medicao = 0; // Última medição mostrada no título
 
     while(running){
+        // Dorme até chegar uma tecla, um quadro novo ou outro evento da janela
+        if (!SDL_WaitEvent(&e)) break;
 
-        while (SDL_PollEvent(&e)) {
+        bool redesenhar = false; // Desenha o último quadro de novo (ex: janela exposta)
+        do {
             if (e.type == SDL_QUIT) {
                 running = 0;
-            } else if (e.type == SDL_KEYDOWN) {
-                if (e.key.keysym.scancode == SDL_SCANCODE_ESCAPE) {
-                    running = 0;
-                }
-                uint8_t chip8_key = key_map[e.key.keysym.scancode];
-                // Ignora '0' que é o valor padrão
-                if (chip8_key != 0 || e.key.keysym.scancode == SDL_SCANCODE_X) { 
-                    vm.VM_ProcessarInput(chip8_key, true);
-                }
-            } else if (e.type == SDL_KEYUP) {
-                uint8_t chip8_key = key_map[e.key.keysym.scancode];
-                if (chip8_key != 0 || e.key.keysym.scancode == SDL_SCANCODE_X) {
-                    vm.VM_ProcessarInput(chip8_key, false);
+            } else if (e.type == em.evento_quadro) {
+                em.quadro_avisado = false;
+            } else if (e.type == SDL_WINDOWEVENT && e.window.event == SDL_WINDOWEVENT_EXPOSED) {
+                redesenhar = true;
+            } else if ((e.type == SDL_KEYDOWN || e.type == SDL_KEYUP) && !e.key.repeat) {
+                SDL_Scancode tecla = e.key.keysym.scancode;
+                bool apertada = e.type == SDL_KEYDOWN;
+                Comando cmd;
+                cmd.tipo = CMD_TECLA;
+                cmd.tecla = key_map[tecla];
+                cmd.apertada = apertada ? 1 : 0;
+
+                if (tecla == SDL_SCANCODE_ESCAPE) {
+                    if (apertada) running = 0;
+                    continue;
+                } else if (tecla == SDL_SCANCODE_BACKSPACE) {
+                    cmd.tipo = CMD_VOLTAR;
+                } else if (tecla == SDL_SCANCODE_F5 || tecla == SDL_SCANCODE_F9) {
+                    if (!apertada) continue;
+                    cmd.tipo = tecla == SDL_SCANCODE_F5 ? CMD_SALVAR_ESTADO : CMD_CARREGAR_ESTADO;
+                } else if (cmd.tecla == 0 && tecla != SDL_SCANCODE_X) {
+                    // Ignora '0' que é o valor padrão
+                    continue;
                 }
+
+                // A fila só enche se a emulação estiver travada; aí a tecla se perde
+                if (em.comandos.Colocar(cmd)) em.despertador.Avisar();
+            }
+        } while (running && SDL_PollEvent(&e));
+
+        // Desenha o último quadro publicado pela emulação
+        bool novo = em.tela.Atualizar();
+        if (novo || redesenhar) {
+            const QuadroTela& q = em.tela.Leitura();
+            desenhar_display(renderer, textura, q.DISPLAY, q.hires);
+
+            // Atualiza o título com a frequência medida e o tempo por quadro
+            if (q.medicao != medicao) {
+                medicao = q.medicao;
+                char titulo[128];
+                snprintf(titulo, sizeof(titulo), "CHIP-8 Emulator - %.0f Hz (alvo %d) - %.3f ms/quadro",
+                         q.hz_medido, chip8_frequency, q.ms_quadro);
+                SDL_SetWindowTitle(window, titulo);
             }
         }
+    }
 
-        //Executa 'N' ciclos da CPU
-        for (int i = 0; i < cycles_per_frame; ++i) {
-            vm.VM_ExecutarInstrucao();
-            #ifdef DEBUG
-            vm.VM_ImprimirRegistradores();
-            #endif
+    em.sair = true;
+    em.despertador.Avisar();
+    emulacao.join();
+    
+    if (gravando) {
+        // Eventos depois do último quadro emulado não chegaram a ter efeito
+        while (!gravacao.eventos.empty() && gravacao.eventos.back().quadro >= gravacao.quadros) {
+            gravacao.eventos.pop_back();
+        }
+        std::string erro;
+        if (Gravacao_Salvar(gravacao, arquivo_gravacao, &erro)) {
+            fprintf(stderr, "Gravação salva em '%s' (%u quadros, %zu eventos)\n",
+                    arquivo_gravacao, gravacao.quadros, gravacao.eventos.size());
+        } else {
+            fprintf(stderr, "Erro: gravação '%s': %s\n", arquivo_gravacao, erro.c_str());
         }
-        
-        //Processa timers a 60Hz
-        vm.VM_ProcessarTimers();
+    }
 
-        //Desenha a 60Hz
-        desenhar_display(renderer, &vm, pixel_size);
- 
-        // Trava o loop em 60Hz
-        SDL_Delay(timer_delay_ms);
+    if (perfil) {
+        std::string erro;
+        if (perfil->Salvar(prefixo_perfil, &erro)) {
+            fprintf(stderr, "Perfil salvo em '%s.txt' e '%s.folded'\n", prefixo_perfil, prefixo_perfil);
+        } else {
+            fprintf(stderr, "Erro: perfil: %s\n", erro.c_str());
+        }
     }
-    
+
     // Limpeza
-    SDL_CloseAudio();
+    delete motor;
+    if (audio != 0) SDL_CloseAudioDevice(audio);
+    SDL_DestroyTexture(textura);
     SDL_DestroyRenderer(renderer);
     SDL_DestroyWindow(window);
     SDL_Quit();
@@ -0,0 +1,134 @@
+#include "recompilador.h"
+#include "c8analise.h"
+#include "c8decod.h"
+#include "c8rom.h"
+#include <stdio.h>
+#include <string.h>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+#define C8_NOME_OP(NOME, TIPO) #NOME,
+static const char* const recompilador_nomes_op[C8_NUM_OPS] = { C8_OPS(C8_NOME_OP) "" };
+#undef C8_NOME_OP
+
+#define C8_NOME_QUIRKS(NOME, TEXTO) "VM_QUIRKS_" #NOME,
+static const char* const recompilador_nomes_quirks[VM_NUM_QUIRKS] = { C8_LISTA_QUIRKS(C8_NOME_QUIRKS) };
+#undef C8_NOME_QUIRKS
+
+static void recompilador_texto(FILE* f, const char* s) {
+    fputc('"', f);
+    for (; *s; s++) {
+        if (*s == '"' || *s == '\\') fputc('\\', f);
+        if ((unsigned char)*s >= 0x20) fputc(*s, f);
+    }
+    fputc('"', f);
+}
+
+// Um namespace por ROM com as funções dos blocos, a RAM esperada e o
+// ProgramaAOT, registrado na inicialização
+static void recompilador_rom(FILE* f, int indice, const char* nome, const AnaliseROM& a) {
+    char texto[64];
+
+    fprintf(f, "// ");
+    recompilador_texto(f, nome);
+    fprintf(f, ": %zu blocos, %u instruções\nnamespace rom_%d {\n\n", a.blocos.size(), a.instrucoes, indice);
+    fprintf(f, "typedef C8_Quirks<%s> Q;\n\n", recompilador_nomes_quirks[a.quirks]);
+
+    uint32_t base = a.tam_ram, fim = 0;
+    std::vector<uint32_t> num_ops(a.blocos.size());
+    std::vector<bool> espera(a.blocos.size());
+    for (size_t k = 0; k < a.blocos.size(); k++) {
+        const BlocoAnalise& b = a.blocos[k];
+        if (b.inicio < base) base = b.inicio;
+        if (b.fim > fim) fim = b.fim;
+
+        // Instruções do bloco, com o texto para o comentário
+        std::vector<uint32_t> pcs;
+        std::vector<std::string> textos;
+        for (uint32_t pc = b.inicio; pc < b.fim;) {
+            pcs.push_back(pc);
+            pc += Analise_Desmontar(a.RAM.data(), a.tam_ram, pc, texto, sizeof(texto));
+            textos.push_back(texto);
+        }
+        OpDecodificada ultima = C8_Decodificar((a.RAM[pcs.back()] << 8) | a.RAM[pcs.back() + 1]);
+        bool escrita = ultima.op == OP_FX33 || ultima.op == OP_FX55 || ultima.op == OP_5XY2;
+        num_ops[k] = (uint32_t)pcs.size();
+        espera[k] = ultima.op == OP_1NNN || ultima.op == OP_FX0A;
+
+        // O último op de um bloco que escreve na RAM informa a faixa escrita
+        fprintf(f, "static VM_Status b_%03X(VM& vm, uint32_t entrada, uint32_t%s, uint32_t*%s, uint32_t*%s) {\n", b.inicio,
+                escrita && pcs.size() == 1 ? "" : " n", escrita ? " ini_escrita" : "", escrita ? " tam_escrita" : "");
+        fprintf(f, "    switch (entrada) {\n");
+        for (size_t i = 0; i < pcs.size(); i++) {
+            OpDecodificada d = C8_Decodificar((a.RAM[pcs[i]] << 8) | a.RAM[pcs[i] + 1]);
+            if (i > 0) fprintf(f, "        [[fallthrough]];\n");
+            fprintf(f, "    case %zu: %s(%s, 0x%03X, 0x%X, 0x%X, 0x%X, 0x%02X, 0x%03X) // %s\n", i,
+                    escrita && i + 1 == pcs.size() ? "AOT_OP_ESCRITA" : "AOT_OP", recompilador_nomes_op[d.op],
+                    pcs[i], d.X, d.Y, d.N, d.NN, d.NNN, textos[i].c_str());
+        }
+        fprintf(f, "    }\n    return VM_OK;\n}\n\n");
+    }
+
+    fprintf(f, "static const BlocoAOT blocos[] = {\n");
+    for (size_t k = 0; k < a.blocos.size(); k++) {
+        const BlocoAnalise& b = a.blocos[k];
+        fprintf(f, "    { 0x%03X, 0x%03X, %u, %d, b_%03X },\n", b.inicio, b.fim, num_ops[k], espera[k] ? 1 : 0, b.inicio);
+    }
+    fprintf(f, "};\n\n");
+
+    fprintf(f, "static const uint8_t bytes[] = {");
+    for (uint32_t p = base; p < fim; p++) {
+        if ((p - base) % 16 == 0) fprintf(f, "\n   ");
+        fprintf(f, " 0x%02X,", a.RAM[p]);
+    }
+    fprintf(f, "\n};\n\n");
+
+    fprintf(f, "static const ProgramaAOT programa = {\n    ");
+    recompilador_texto(f, nome);
+    fprintf(f, ", %s, %u, 0x%03X, sizeof(bytes), bytes,\n", recompilador_nomes_quirks[a.quirks], a.tam_ram, base);
+    fprintf(f, "    sizeof(blocos) / sizeof(blocos[0]), blocos\n};\n\n");
+    fprintf(f, "static const bool registrado = AOT_Registrar(&programa);\n\n");
+    fprintf(f, "} // namespace rom_%d\n\n", indice);
+}
+
+int Recompilador_Executar(const char* saida, const std::vector<std::string>& roms, VM_Quirks quirks) {
+    if (roms.empty()) {
+        fprintf(stderr, "Erro: --recompilar precisa de pelo menos uma ROM\n");
+        return 1;
+    }
+
+    FILE* f = fopen(saida, "w");
+    if (!f) {
+        fprintf(stderr, "Erro: não foi possível criar '%s'\n", saida);
+        return 1;
+    }
+
+    fprintf(f, "// Gerado por 'chip8_headless --recompilar' (perfil %s). Não edite.\n\n", VM_NomeQuirks(quirks));
+    fprintf(f, "#include \"c8aot.h\"\n#include \"c8ops.h\"\n\n");
+
+    int erros = 0;
+    for (size_t r = 0; r < roms.size(); r++) {
+        std::string erro;
+        const ImagemROM* img = ROM_Carregar(roms[r].c_str(), 0x200, &erro);
+        if (img == NULL || !VM_CabeNoPerfil(img->tam_ram, quirks, &erro)) {
+            fprintf(stderr, "Erro: ROM '%s': %s\n", roms[r].c_str(), erro.c_str());
+            erros++;
+            continue;
+        }
+
+        AnaliseROM analise;
+        Analise_ROM(*img, quirks, &analise);
+        if (analise.blocos.empty()) {
+            fprintf(stderr, "Aviso: ROM '%s' sem código alcançável, ignorada\n", roms[r].c_str());
+            continue;
+        }
+        recompilador_rom(f, (int)r, roms[r].c_str(), analise);
+        fprintf(stderr, "ROM '%s': %zu blocos, %u instruções\n", roms[r].c_str(), analise.blocos.size(), analise.instrucoes);
+    }
+
+    if (fclose(f) != 0) {
+        fprintf(stderr, "Erro: falha ao gravar '%s'\n", saida);
+        return 1;
+    }
+    return erros ? 1 : 0;
+}
@@ -0,0 +1,18 @@
+#ifndef RECOMPILADOR_H
+#define RECOMPILADOR_H
+
+#include <string>
+#include <vector>
+#include "c8vm.h"
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Recompilador: analisa cada ROM (c8analise.h) e gera em 'saida' um fonte
+// C++ com uma função por bloco básico e um ProgramaAOT por ROM (c8aot.h),
+// especializados para o perfil de quirks 'quirks'. Compilado junto com o
+// chip8_headless, o fonte habilita o motor "aot" (veja "make aot"). As ROMs
+// são carregadas em 0x200. Retorna != 0 se alguma ROM não pôde ser lida ou
+// o arquivo não pôde ser escrito.
+int Recompilador_Executar(const char* saida, const std::vector<std::string>& roms, VM_Quirks quirks);
+
+#endif
@@ -0,0 +1,150 @@
+#include "sessao.h"
+#include "c8perfil.h"
+#include "c8rom.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <chrono>
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+static bool evento_antes(const EventoEntrada& a, const EventoEntrada& b) {
+    return a.quadro < b.quadro;
+}
+
+bool Sessao_LerRoteiro(const char* caminho, std::vector<EventoEntrada>& eventos, std::string* erro) {
+    FILE* arq = fopen(caminho, "r");
+    if (!arq) {
+        *erro = std::string("não foi possível abrir o roteiro '") + caminho + "'";
+        return false;
+    }
+
+    char linha[256];
+    int num_linha = 0;
+    while (fgets(linha, sizeof(linha), arq)) {
+        num_linha++;
+        char* comentario = strchr(linha, '#');
+        if (comentario) *comentario = '\0';
+
+        unsigned long quadro;
+        unsigned int tecla, estado;
+        char resto;
+        int lidos = sscanf(linha, "%lu %x %u %c", &quadro, &tecla, &estado, &resto);
+        if (lidos <= 0) continue; // Linha vazia
+
+        if (lidos != 3 || tecla >= CHIP8_KEYS || estado > 1) {
+            char msg[128];
+            snprintf(msg, sizeof(msg), "%s:%d: esperado '<quadro> <tecla hex> <1|0>'", caminho, num_linha);
+            *erro = msg;
+            fclose(arq);
+            return false;
+        }
+
+        EventoEntrada ev;
+        ev.quadro = (uint32_t)quadro;
+        ev.tecla = (uint8_t)tecla;
+        ev.pressionada = (uint8_t)estado;
+        eventos.push_back(ev);
+    }
+    fclose(arq);
+
+    std::stable_sort(eventos.begin(), eventos.end(), evento_antes);
+    return true;
+}
+
+void Sessao_AplicarEntrada(VM& vm, uint64_t quadro, const std::vector<EventoEntrada>& eventos, size_t* prox_evento) {
+    while (*prox_evento < eventos.size() && eventos[*prox_evento].quadro <= quadro) {
+        const EventoEntrada& ev = eventos[(*prox_evento)++];
+        vm.VM_ProcessarInput(ev.tecla, ev.pressionada != 0);
+    }
+}
+
+ResultadoSessao Sessao_Rodar(VM& vm, Motor& motor, uint64_t ciclos, int hz,
+                             const std::vector<EventoEntrada>& eventos) {
+    ResultadoSessao res;
+    res.status = VM_OK;
+    res.ciclos = 0;
+    res.quadros = 0;
+
+    size_t prox_evento = 0;
+    while (res.ciclos < ciclos) {
+        uint64_t quadro = res.quadros;
+        Sessao_AplicarEntrada(vm, quadro, eventos, &prox_evento);
+
+        uint64_t n = Sessao_CiclosQuadro(quadro, hz);
+        if (n > ciclos - res.ciclos) n = ciclos - res.ciclos;
+
+        res.status = motor.Executar(vm, n);
+        if (res.status != VM_OK) return res; // Ciclos do quadro com falha não são contados
+        res.ciclos += n;
+
+        vm.VM_ProcessarTimers();
+        res.quadros++;
+    }
+    return res;
+}
+
+int Sessao_Reproduzir(const char* arq_gravacao, const char* rom, const char* nome_motor,
+                      const char* perfil) {
+    Gravacao g;
+    std::string erro;
+    if (!Gravacao_Carregar(g, arq_gravacao, &erro)) {
+        fprintf(stderr, "Erro: gravação '%s': %s\n", arq_gravacao, erro.c_str());
+        return 1;
+    }
+    if (g.hz == 0) {
+        fprintf(stderr, "Erro: gravação '%s': hz inválido\n", arq_gravacao);
+        return 1;
+    }
+    if (g.quirks >= VM_NUM_QUIRKS) {
+        fprintf(stderr, "Erro: gravação '%s': perfil de quirks desconhecido\n", arq_gravacao);
+        return 1;
+    }
+
+    MotorPerfil* motor_perfil = perfil ? new MotorPerfil() : NULL;
+    if (motor_perfil) nome_motor = "perfil";
+    Motor* motor = motor_perfil ? motor_perfil : Motor_Criar(nome_motor);
+    if (motor == NULL) {
+        fprintf(stderr, "Erro: Motor desconhecido '%s' (use: %s)\n", nome_motor, MOTORES_DISPONIVEIS);
+        return 1;
+    }
+
+    const ImagemROM* img = ROM_Carregar(rom, g.pc_inicial, &erro);
+    if (img == NULL || !VM_CabeNoPerfil(img->tam_ram, (VM_Quirks)g.quirks, &erro)) {
+        fprintf(stderr, "Erro: ROM '%s': %s\n", rom, erro.c_str());
+        delete motor;
+        return 1;
+    }
+
+    VM vm;
+    vm.VM_Inicializar(img->pc_inicial, img->RAM.data(), img->tam_ram);
+    vm.VM_Semear(g.semente);
+    vm.VM_DefinirQuirks((VM_Quirks)g.quirks, NULL); // A ROM já foi conferida
+    if (vm.VM_HashEstado() != g.hash_inicial) {
+        fprintf(stderr, "Erro: a ROM '%s' não é a da gravação '%s'\n", rom, arq_gravacao);
+        delete motor;
+        return 1;
+    }
+
+    // Os quadros de hz/60 ciclos somam exatamente quadros * hz / 60
+    uint64_t ciclos = (uint64_t)g.quadros * g.hz / 60;
+    std::chrono::steady_clock::time_point t0 = std::chrono::steady_clock::now();
+    ResultadoSessao res = Sessao_Rodar(vm, *motor, ciclos, (int)g.hz, g.eventos);
+    double segundos = std::chrono::duration<double>(std::chrono::steady_clock::now() - t0).count();
+
+    uint64_t hash = vm.VM_HashEstado();
+    printf("{\"gravacao\":\"%s\",\"motor\":\"%s\",\"quadros\":%u,\"ciclos\":%llu,\"segundos\":%.6f,"
+           "\"instrucoes_por_segundo\":%.0f,\"status\":\"%s\",\"hash_estado\":\"%016llx\","
+           "\"hash_gravado\":\"%016llx\",\"identico\":%s}\n",
+           arq_gravacao, nome_motor, g.quadros, (unsigned long long)res.ciclos, segundos,
+           segundos > 0 ? res.ciclos / segundos : 0.0, VM_DescreverStatus(res.status),
+           (unsigned long long)hash, (unsigned long long)g.hash_final,
+           hash == g.hash_final ? "true" : "false");
+
+    if (motor_perfil && !motor_perfil->Salvar(perfil, &erro)) {
+        fprintf(stderr, "Erro: perfil: %s\n", erro.c_str());
+    }
+    delete motor;
+    return hash == g.hash_final ? 0 : 1;
+}
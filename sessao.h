@@ -0,0 +1,47 @@
+#ifndef SESSAO_H
+#define SESSAO_H
+
+#include <stdint.h>
+#include <string>
+#include <vector>
+#include "c8vm.h"
+#include "c8motor.h"
+#include "c8gravacao.h" // EventoEntrada
+
+//Autores: Guilherme Inoe, Winicius Abilio
+
+// Execução sem janela de uma VM: quadros de 60Hz com hz/60 ciclos cada
+// (a fração é distribuída entre os quadros, sem deriva), entrada aplicada no
+// início do quadro e timers no fim, como no laço do frontend.
+
+struct ResultadoSessao {
+    VM_Status status;
+    uint64_t ciclos;      // Ciclos executados (até a falha, se houver)
+    uint64_t quadros;     // Quadros completos
+};
+
+// Lê um roteiro de entrada em texto: uma linha "<quadro> <tecla hex> <1|0>"
+// por evento; '#' inicia um comentário. Os eventos voltam ordenados por quadro.
+bool Sessao_LerRoteiro(const char* caminho, std::vector<EventoEntrada>& eventos, std::string* erro);
+
+// Partes de um quadro, para quem roda quadro a quadro (ex: conformidade.h):
+// aplica os eventos até o quadro 'quadro', a partir de *prox_evento
+void Sessao_AplicarEntrada(VM& vm, uint64_t quadro, const std::vector<EventoEntrada>& eventos, size_t* prox_evento);
+
+// Ciclos do quadro 'quadro' (os quadros 0..q-1 somam q * hz / 60)
+inline uint64_t Sessao_CiclosQuadro(uint64_t quadro, int hz) {
+    return (quadro + 1) * hz / 60 - quadro * hz / 60;
+}
+
+// Roda até 'ciclos' instruções (ou até a primeira falha)
+ResultadoSessao Sessao_Rodar(VM& vm, Motor& motor, uint64_t ciclos, int hz,
+                             const std::vector<EventoEntrada>& eventos);
+
+// Reproduz uma gravação de entrada (c8gravacao.h) sobre a ROM, na
+// velocidade máxima, e imprime uma linha JSON comparando o estado final com
+// o gravado. Retorna 0 se for idêntico. Com 'perfil' != NULL roda no
+// MotorPerfil e grava o perfil com esse prefixo (veja c8perfil.h).
+int Sessao_Reproduzir(const char* arq_gravacao, const char* rom, const char* nome_motor,
+                      const char* perfil);
+
+#endif